@@ -1,10 +1,15 @@
 #include "AuthDatabase.h"
+#include "DataVersions.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
+#include "Database.h"
 
 AuthDatabase::RegisterResult AuthDatabase::addUser(const QString &login, const QString &password, const QString &email) {
+    METRICS_QUERY_SCOPE("AuthDatabase::addUser");
     QString hashedPassword = hashPassword(password);
 
-    QSqlQuery checkQuery;
-    checkQuery.prepare("SELECT COUNT(*) FROM users WHERE user_login = :login");
+    PooledConnection connection;
+    QSqlQuery &checkQuery = connection.prepared("SELECT COUNT(*) FROM users WHERE user_login = :login");
     checkQuery.bindValue(":login", login);
     if (!checkQuery.exec() || !checkQuery.next()) {
         qCritical() << "Login check failed:" << checkQuery.lastError().text();
@@ -17,8 +22,7 @@ AuthDatabase::RegisterResult AuthDatabase::addUser(const QString &login, const Q
     }
 
     // Добавление пользователя
-    QSqlQuery query;
-    query.prepare(R"(
+    QSqlQuery &query = connection.prepared(R"(
         INSERT INTO users (user_login, user_email, user_passhach)
         VALUES (:login, :email, :password)
     )");
@@ -32,8 +36,7 @@ AuthDatabase::RegisterResult AuthDatabase::addUser(const QString &login, const Q
     }
 
     // Добавление папки
-    QSqlQuery folderQuery;
-    folderQuery.prepare(R"(
+    QSqlQuery &folderQuery = connection.prepared(R"(
         INSERT INTO folders (name, user_login)
         VALUES (:name, :login)
     )");
@@ -45,13 +48,18 @@ AuthDatabase::RegisterResult AuthDatabase::addUser(const QString &login, const Q
         return RegisterResult::DatabaseError;
     }
 
+    // логин мог принадлежать удалённому пользователю, чьи ответы ещё лежат у клиента
+    DataVersions::bumpAll(login);
+    EntryPageCache::instance().invalidateUser(login);
+    MoodColumnsCache::instance().invalidateUser(login);
     return RegisterResult::Success;
 }
 
 AuthDatabase::UserInfo AuthDatabase::getUserInfoByLogin(const QString &login) {
+    METRICS_QUERY_SCOPE("AuthDatabase::getUserInfoByLogin");
     UserInfo userInfo;
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT user_login, user_passhach, user_email FROM users WHERE user_login = :login
     )");
     query.bindValue(":login", login);
@@ -74,8 +82,9 @@ AuthDatabase::UserInfo AuthDatabase::getUserInfoByLogin(const QString &login) {
 
 QString AuthDatabase::changeUserPassword(const QString &login, const QString &oldPassword, const QString &newPassword)
 {
-    QSqlQuery query;
-    query.prepare(R"(SELECT user_passhach FROM users WHERE user_login = :login)");
+    METRICS_QUERY_SCOPE("AuthDatabase::changeUserPassword");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(SELECT user_passhach FROM users WHERE user_login = :login)");
     query.bindValue(":login", login);
 
     if (!query.exec() || !query.next()) {
@@ -89,16 +98,16 @@ QString AuthDatabase::changeUserPassword(const QString &login, const QString &ol
     }
 
     QString hashedNewPassword = hashPassword(newPassword);
-    query.prepare(R"(UPDATE users SET user_passhach = :newPassword WHERE user_login = :login)");
-    query.bindValue(":newPassword", hashedNewPassword);
-    query.bindValue(":login", login);
+    QSqlQuery &updateQuery = connection.prepared(R"(UPDATE users SET user_passhach = :newPassword WHERE user_login = :login)");
+    updateQuery.bindValue(":newPassword", hashedNewPassword);
+    updateQuery.bindValue(":login", login);
 
-    if (!query.exec()) {
-        qCritical() << "Failed to update password:" << query.lastError().text();
+    if (!updateQuery.exec()) {
+        qCritical() << "Failed to update password:" << updateQuery.lastError().text();
         return "* Ошибка при изменении пароля";
     }
 
-    if (query.numRowsAffected() == 0) {
+    if (updateQuery.numRowsAffected() == 0) {
         return "* Пароль не обновлён";
     }
 
@@ -108,9 +117,10 @@ QString AuthDatabase::changeUserPassword(const QString &login, const QString &ol
 
 std::pair<AuthDatabase::UserInfo, QString> AuthDatabase::recoverUserPasswordByEmail(const QString &email, const QString &newPassword)
 {
+    METRICS_QUERY_SCOPE("AuthDatabase::recoverUserPasswordByEmail");
     UserInfo userInfo;
-    QSqlQuery query;
-    query.prepare(R"(SELECT id, user_login FROM users WHERE user_email = :email)");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(SELECT id, user_login FROM users WHERE user_email = :email)");
     query.bindValue(":email", email);
 
     if (!query.exec()) {
@@ -127,8 +137,7 @@ std::pair<AuthDatabase::UserInfo, QString> AuthDatabase::recoverUserPasswordByEm
     userInfo.email = email;
     userInfo.hashedPassword = hashPassword(newPassword);
 
-    QSqlQuery updateQuery;
-    updateQuery.prepare(R"(UPDATE users SET user_passhach = :newPassword WHERE id = :id)");
+    QSqlQuery &updateQuery = connection.prepared(R"(UPDATE users SET user_passhach = :newPassword WHERE id = :id)");
     updateQuery.bindValue(":newPassword", userInfo.hashedPassword);
     updateQuery.bindValue(":id", userId);
 
@@ -147,9 +156,10 @@ std::pair<AuthDatabase::UserInfo, QString> AuthDatabase::recoverUserPasswordByEm
 }
 
 bool AuthDatabase::changeUserEmail(const QString &login, const QString &email) {
+    METRICS_QUERY_SCOPE("AuthDatabase::changeUserEmail");
 
-    QSqlQuery query;
-    query.prepare(R"(UPDATE users SET user_email = :email WHERE user_login = :login)");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(UPDATE users SET user_email = :email WHERE user_login = :login)");
     query.bindValue(":email", email);
     query.bindValue(":login", login);
 
@@ -169,16 +179,35 @@ bool AuthDatabase::changeUserEmail(const QString &login, const QString &email) {
 
 bool AuthDatabase::deleteUserByLogin(const QString &login)
 {
-    QSqlQuery query;
+    METRICS_QUERY_SCOPE("AuthDatabase::deleteUserByLogin");
+    PooledConnection connection;
+    DatabaseTransaction transaction(connection.database());
+    if (!transaction.isActive())
+        return false;
 
-    // SQL запрос для удаления пользователя по логину
-    QString deleteQuery = QString("DELETE FROM users WHERE user_login = '%1'").arg(login);
+    QSqlQuery &query = connection.prepared(R"(DELETE FROM users WHERE user_login = :login)");
+    query.bindValue(":login", login);
 
-    if (!query.exec(deleteQuery)) {
+    if (!query.exec()) {
         qCritical() << "Failed to delete user:" << query.lastError().text();
         return false;
     }
 
+    // у сводки нет внешнего ключа на users, каскад её не удалит
+    QSqlQuery &statsQuery = connection.prepared(R"(DELETE FROM daily_mood_stats WHERE user_login = :login)");
+    statsQuery.bindValue(":login", login);
+    if (!statsQuery.exec()) {
+        qCritical() << "Failed to delete mood stats:" << statsQuery.lastError().text();
+        return false;
+    }
+
+    if (!transaction.commit())
+        return false;
+
+    DataVersions::bumpAll(login);
+    EntryPageCache::instance().invalidateUser(login);
+    MoodColumnsCache::instance().invalidateUser(login);
+
     qInfo() << "User with login" << login << "deleted successfully.";
     return true;
 }
@@ -20,9 +20,10 @@ public:
     QHttpServerResponse handleEmailChange(const QHttpServerRequest &request);
     QHttpServerResponse handleLoginToDelete(const QHttpServerRequest &request);
 
+    static QString hashPassword(const QString &password);
+
 private:
     bool deleteUserFromDatabase(const QString &login);
-    static QString hashPassword(const QString &password);
 
 };
 
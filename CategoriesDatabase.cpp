@@ -1,14 +1,18 @@
 #include "CategoriesDatabase.h"
+#include "DataVersions.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
 
 bool CategoriesDatabase::saveUserTag(const QString &login, const QString &tag, QString &errorMessage)
 {
+    METRICS_QUERY_SCOPE("CategoriesDatabase::saveUserTag");
     if (login.trimmed().isEmpty() || tag.trimmed().isEmpty()) {
         errorMessage = "Login или тег не могут быть пустыми";
         return false;
     }
 
-    QSqlQuery checkQuery;
-    checkQuery.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &checkQuery = connection.prepared(R"(
         SELECT 1 FROM user_tags WHERE user_login = :login AND name = :tag
     )");
     checkQuery.bindValue(":login", login.trimmed());
@@ -23,8 +27,7 @@ bool CategoriesDatabase::saveUserTag(const QString &login, const QString &tag, Q
         errorMessage = "* Такой тег уже существует";
         return false;
     }
-    QSqlQuery insertQuery;
-    insertQuery.prepare(R"(
+    QSqlQuery &insertQuery = connection.prepared(R"(
         INSERT INTO user_tags (name, user_login)
         VALUES (:name, :login)
     )");
@@ -36,15 +39,17 @@ bool CategoriesDatabase::saveUserTag(const QString &login, const QString &tag, Q
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Tags);
     return true;
 }
 
 QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserTags(const QString &login)
 {
+    METRICS_QUERY_SCOPE("CategoriesDatabase::getUserTags");
     QList<UserItem> tags;
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT id, name
         FROM user_tags
         WHERE user_login = :login
@@ -67,8 +72,9 @@ QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserTags(const QStrin
 
 bool CategoriesDatabase::deleteTag(const QString &login, const QString &tag)
 {
-    QSqlQuery query;
-    query.prepare(R"(
+    METRICS_QUERY_SCOPE("CategoriesDatabase::deleteTag");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         DELETE FROM user_tags
         WHERE user_login = :login AND name = :tag
     )");
@@ -79,13 +85,16 @@ bool CategoriesDatabase::deleteTag(const QString &login, const QString &tag)
         return false;
     }
 
+    DataVersions::bump(login, {DataVersions::Collection::Tags, DataVersions::Collection::Entries});
+    EntryPageCache::instance().invalidateUser(login);
     return true;
 }
 
 bool CategoriesDatabase::saveUserActivity(const QString &login, const QString &iconId, const QString &iconLabel)
 {
-    QSqlQuery query;
-    query.prepare(R"(
+    METRICS_QUERY_SCOPE("CategoriesDatabase::saveUserActivity");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         INSERT INTO user_activities (user_login, icon_id, icon_label)
         VALUES (:login, :icon_id, :icon_label)
         ON CONFLICT (user_login, icon_label) DO NOTHING
@@ -99,15 +108,17 @@ bool CategoriesDatabase::saveUserActivity(const QString &login, const QString &i
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Activities);
     return true;
 }
 
 QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserActivities(const QString &login)
 {
+    METRICS_QUERY_SCOPE("CategoriesDatabase::getUserActivities");
     QList<UserItem> activities;
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT id, icon_id, icon_label
         FROM user_activities
         WHERE user_login = :login
@@ -133,8 +144,9 @@ QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserActivities(const
 
 bool CategoriesDatabase::deleteActivity(const QString &login, const QString &activity)
 {
-    QSqlQuery query;
-    query.prepare(R"(
+    METRICS_QUERY_SCOPE("CategoriesDatabase::deleteActivity");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         DELETE FROM user_activities
         WHERE user_login = :login AND icon_label = :activity
     )");
@@ -151,14 +163,18 @@ bool CategoriesDatabase::deleteActivity(const QString &login, const QString &act
         return false;
     }
 
+    DataVersions::bump(login, {DataVersions::Collection::Activities, DataVersions::Collection::Entries});
+    EntryPageCache::instance().invalidateUser(login);
+    MoodColumnsCache::instance().invalidateUser(login);
     return true;
 }
 
 bool CategoriesDatabase::saveUserEmotion(const QString &login, const QString &iconId, const QString &iconLabel)
 {
+    METRICS_QUERY_SCOPE("CategoriesDatabase::saveUserEmotion");
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         INSERT INTO user_emotions (user_login, icon_id, icon_label)
         VALUES (:login, :icon_id, :icon_label)
         ON CONFLICT (user_login, icon_label) DO NOTHING
@@ -172,15 +188,17 @@ bool CategoriesDatabase::saveUserEmotion(const QString &login, const QString &ic
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Emotions);
     return true;
 }
 
 QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserEmotions(const QString &login)
 {
+    METRICS_QUERY_SCOPE("CategoriesDatabase::getUserEmotions");
     QList<UserItem> emotions;
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT id, icon_id, icon_label
         FROM user_emotions
         WHERE user_login = :login
@@ -205,8 +223,9 @@ QList<CategoriesDatabase::UserItem> CategoriesDatabase::getUserEmotions(const QS
 
 bool CategoriesDatabase::deleteEmotion(const QString &login, const QString &emotion)
 {
-    QSqlQuery query;
-    query.prepare(R"(
+    METRICS_QUERY_SCOPE("CategoriesDatabase::deleteEmotion");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         DELETE FROM user_emotions
         WHERE user_login = :login AND icon_label = :emotion
     )");
@@ -224,5 +243,8 @@ bool CategoriesDatabase::deleteEmotion(const QString &login, const QString &emot
         return false;
     }
 
+    DataVersions::bump(login, {DataVersions::Collection::Emotions, DataVersions::Collection::Entries});
+    EntryPageCache::instance().invalidateUser(login);
+    MoodColumnsCache::instance().invalidateUser(login);
     return true;
 }
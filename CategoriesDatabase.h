@@ -6,6 +6,8 @@
 #include <QSqlQuery>
 #include <QDebug>
 #include <QCryptographicHash>
+#include "ConnectionPool.h"
+#include "Metrics.h"
 
 class CategoriesDatabase {
 
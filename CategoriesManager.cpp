@@ -1,5 +1,6 @@
 #include "CategoriesManager.h"
 #include "CategoriesDatabase.h"
+#include "DataVersions.h"
 
 CategoriesManager::CategoriesManager(QObject *parent)
     : QObject(parent)
@@ -45,6 +46,10 @@ QHttpServerResponse CategoriesManager::handleGetUserTags(const QHttpServerReques
         return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
     }
 
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Tags);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
+
     // Теперь возвращается QList<UserItem>
     QList<CategoriesDatabase::UserItem> tags = CategoriesDatabase::getUserTags(login);
 
@@ -63,7 +68,9 @@ QHttpServerResponse CategoriesManager::handleGetUserTags(const QHttpServerReques
     QJsonObject response;
     response["tags"] = tagArray;
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse httpResponse("application/json", QJsonDocument(response).toJson());
+    DataVersions::setETag(httpResponse, etag);
+    return httpResponse;
 }
 
 QHttpServerResponse CategoriesManager::handleDeleteTag(const QHttpServerRequest &request)
@@ -133,6 +140,10 @@ QHttpServerResponse CategoriesManager::handleGetUserEmotions(const QHttpServerRe
         return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
     }
 
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Emotions);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
+
     QList<CategoriesDatabase::UserItem> emotions = CategoriesDatabase::getUserEmotions(login);
 
     if (emotions.isEmpty()) {
@@ -151,7 +162,9 @@ QHttpServerResponse CategoriesManager::handleGetUserEmotions(const QHttpServerRe
     QJsonObject response;
     response["emotions"] = emotionsArray;
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse httpResponse("application/json", QJsonDocument(response).toJson());
+    DataVersions::setETag(httpResponse, etag);
+    return httpResponse;
 }
 
 QHttpServerResponse CategoriesManager::handleDeleteEmotion(const QHttpServerRequest &request)
@@ -221,6 +234,10 @@ QHttpServerResponse CategoriesManager::handleGetUserActivity(const QHttpServerRe
         return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
     }
 
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Activities);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
+
     QList<CategoriesDatabase::UserItem> activities = CategoriesDatabase::getUserActivities(login);
 
     if (activities.isEmpty()) {
@@ -239,7 +256,9 @@ QHttpServerResponse CategoriesManager::handleGetUserActivity(const QHttpServerRe
     QJsonObject response;
     response["activities"] = activitiesArray;
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse httpResponse("application/json", QJsonDocument(response).toJson());
+    DataVersions::setETag(httpResponse, etag);
+    return httpResponse;
 }
 
 
@@ -1,102 +1,612 @@
 #include "ComputeDatabase.h"
+#include "Trace.h"
 
-QList<EntryUser> ComputeDatabase::getEntriesByLastMonth(const QString &login, const QString &lastMonth)
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <array>
+
+namespace {
+
+// ROUND(sum / count, 2) в PostgreSQL: деление точное, половина округляется
+// от нуля; без записей — null, как NULLIF(count, 0).
+QJsonValue roundedRatio(qint64 numerator, qint64 denominator)
 {
-    QList<EntryUser> entries;
+    if (denominator == 0)
+        return QJsonValue();
+    if (denominator < 0) {
+        numerator = -numerator;
+        denominator = -denominator;
+    }
+    const qint64 scaled = numerator * 100;
+    qint64 hundredths = scaled / denominator;
+    if (2 * qAbs(scaled % denominator) >= denominator)
+        hundredths += scaled < 0 ? -1 : 1;
+    return double(hundredths) / 100;
+}
+
+struct MoodTotals {
+    qint64 entryCount = 0;
+    qint64 moodSum = 0;
+    int activeDays = 0;
 
-    if (login.isEmpty() || lastMonth.isEmpty()) {
-        qWarning() << "Login or lastMonth is empty.";
-        return entries;
+    void add(qint64 count, qint64 sum)
+    {
+        entryCount += count;
+        moodSum += sum;
+        activeDays += count > 0 ? 1 : 0;
     }
+};
 
-    QString queryStr = R"(
-        SELECT e.id, e.entry_mood_id, e.entry_date
-        FROM entries e
-        WHERE e.user_login = ?
-          AND TO_CHAR(e.entry_date, 'YYYY-MM') = ?
-        ORDER BY e.entry_date ASC
-    )";
+} // namespace
 
-    QSqlQuery query;
-    if (!query.prepare(queryStr)) {
-        qWarning() << "Query prepare failed:" << query.lastError().text();
-        return entries;
+QList<TimeSeriesBucket> ComputeDatabase::getEntriesSeries(const QString &login, const QDate &from, const QDate &to,
+                                                          TimeBucket bucket, bool *ok)
+{
+    METRICS_QUERY_SCOPE("ComputeDatabase::getEntriesSeries");
+    if (ok)
+        *ok = false;
+
+    if (login.isEmpty() || !from.isValid() || !to.isValid() || from >= to) {
+        qWarning() << "Invalid series request:" << login << from << to;
+        return QList<TimeSeriesBucket>();
     }
 
-    query.addBindValue(login);
-    query.addBindValue(lastMonth);  // Пример: "2025-04"
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
+        SELECT id, entry_mood_id, entry_date
+        FROM entries
+        WHERE user_login = :login
+          AND entry_date >= CAST(:from AS date)
+          AND entry_date < CAST(:to AS date)
+        ORDER BY entry_date, entry_time, id
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":from", from.toString(Qt::ISODate));
+    query.bindValue(":to", to.toString(Qt::ISODate));
 
     if (!query.exec()) {
-        qWarning() << "Failed to get entries by last month:" << query.lastError().text();
-        return entries;
+        qWarning() << "Failed to get entries series:" << query.lastError().text();
+        return QList<TimeSeriesBucket>();
     }
 
+    // строки отсортированы по дате, поэтому интервал только сдвигается вперёд
+    QList<TimeSeriesBucket> buckets = emptyBuckets(from, to, bucket);
+    qsizetype current = 0;
     while (query.next()) {
-        int entryId = query.value("id").toInt();
-        int moodId = query.value("entry_mood_id").toInt();
-        QDate date = query.value("entry_date").toDate();
+        EntryUser entry;
+        entry.id = query.value(0).toInt();
+        entry.userLogin = login;
+        entry.moodId = query.value(1).toInt();
+        entry.date = query.value(2).toDate();
+
+        while (current + 1 < buckets.size() && entry.date >= buckets[current + 1].start)
+            ++current;
+        buckets[current].entries.append(entry);
+    }
+
+    if (ok)
+        *ok = true;
+    return buckets;
+}
+
+QList<TimeSeriesBucket> ComputeDatabase::getDailyStatsSeries(const QString &login, const QDate &from, const QDate &to,
+                                                             TimeBucket bucket, bool *ok)
+{
+    METRICS_QUERY_SCOPE("ComputeDatabase::getDailyStatsSeries");
+    if (ok)
+        *ok = false;
+
+    bool loaded = false;
+    const QList<DailyMoodStats> days = getDailyMoodStats(login, from, to, &loaded);
+    if (!loaded || from >= to)
+        return QList<TimeSeriesBucket>();
+
+    QList<TimeSeriesBucket> buckets = emptyBuckets(from, to, bucket);
+    qsizetype current = 0;
+    for (const DailyMoodStats &day : days) {
+        while (current + 1 < buckets.size() && day.date >= buckets[current + 1].start)
+            ++current;
+        buckets[current].days.append(day);
+    }
+
+    if (ok)
+        *ok = true;
+    return buckets;
+}
+
+MoodColumns ComputeDatabase::loadMoodColumns(const QString &login, const QDate &from, const QDate &to, bool *ok)
+{
+    METRICS_QUERY_SCOPE("ComputeDatabase::loadMoodColumns");
+    MoodColumns columns;
+    if (ok)
+        *ok = false;
 
-        QString emptyStr;
-        QTime emptyTime;
-        QVector<UserItem> emptyTags;
-        QVector<UserItem> emptyActivities;
-        QVector<UserItem> emptyEmotions;
+    if (login.isEmpty()) {
+        qWarning() << "Login is empty.";
+        return columns;
+    }
+
+    // Связи агрегируются одним GROUP BY по записям пользователя и присоединяются
+    // к ним, а не подзапросом на каждую запись: вся история читается за один
+    // проход по каждой таблице. Приходят строкой "1,2,3" — так не нужен разбор
+    // литерала массива.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
+        WITH user_entries AS (
+            SELECT id, entry_date, entry_time, entry_mood_id
+            FROM entries
+            WHERE user_login = :login
+              AND entry_mood_id IS NOT NULL
+              AND (CAST(:from AS date) IS NULL OR entry_date >= CAST(:from AS date))
+              AND (CAST(:to AS date) IS NULL OR entry_date < CAST(:to AS date))
+        ),
+        activities AS (
+            SELECT a.entry_id, string_agg(CAST(a.user_activity_id AS text), ',') AS ids
+            FROM entry_user_activities a
+            JOIN user_entries u ON u.id = a.entry_id
+            GROUP BY a.entry_id
+        ),
+        emotions AS (
+            SELECT m.entry_id, string_agg(CAST(m.user_emotion_id AS text), ',') AS ids
+            FROM entry_user_emotions m
+            JOIN user_entries u ON u.id = m.entry_id
+            GROUP BY m.entry_id
+        )
+        SELECT u.id, u.entry_date, u.entry_time, u.entry_mood_id,
+               COALESCE(act.ids, ''), COALESCE(emo.ids, '')
+        FROM user_entries u
+        LEFT JOIN activities act ON act.entry_id = u.id
+        LEFT JOIN emotions emo ON emo.entry_id = u.id
+        ORDER BY u.entry_date, u.entry_time, u.id
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":from", from.isValid() ? QVariant(from.toString(Qt::ISODate)) : QVariant());
+    query.bindValue(":to", to.isValid() ? QVariant(to.toString(Qt::ISODate)) : QVariant());
+
+    if (!query.exec()) {
+        qWarning() << "Failed to load mood columns:" << query.lastError().text();
+        return columns;
+    }
 
-        EntryUser entry(entryId, login, emptyStr, emptyStr, moodId, -1, date, emptyTime,
-                        emptyTags, emptyActivities, emptyEmotions);
-        entries.append(entry);
+    QList<int> activities;
+    QList<int> emotions;
+    auto parseIds = [](const QString &text, QList<int> &ids) {
+        ids.clear();
+        for (QStringView part : QStringView(text).split(u',', Qt::SkipEmptyParts))
+            ids.append(part.toInt());
+    };
+
+    while (query.next()) {
+        parseIds(query.value(4).toString(), activities);
+        parseIds(query.value(5).toString(), emotions);
+        columns.append(query.value(0).toInt(), query.value(1).toDate(), query.value(2).toTime(), query.value(3).toInt(),
+                       activities, emotions);
     }
 
-    return entries;
+    if (ok)
+        *ok = true;
+    return columns;
 }
 
-QList<EntryUser> ComputeDatabase::getEntriesByCurrentMonth(const QString &login, const QString &currentMonth)
+QList<TimeSeriesBucket> ComputeDatabase::entriesSeries(const MoodColumns &columns, const QString &login, const QDate &from,
+                                                       const QDate &to, TimeBucket bucket)
 {
-    QList<EntryUser> entries;
+    QList<TimeSeriesBucket> buckets = emptyBuckets(from, to, bucket);
+    const auto [first, last] = columns.range(from, to);
+    qsizetype current = 0;
+    for (std::size_t i = first; i < last; ++i) {
+        EntryUser entry;
+        entry.id = columns.entryIds[i];
+        entry.userLogin = login;
+        entry.moodId = columns.moods[i];
+        entry.date = QDate::fromJulianDay(columns.days[i]);
 
-    if (login.isEmpty() || currentMonth.isEmpty()) {
-        qWarning() << "Login or currentMonth is empty.";
-        return entries;
+        while (current + 1 < buckets.size() && entry.date >= buckets[current + 1].start)
+            ++current;
+        buckets[current].entries.append(entry);
     }
+    return buckets;
+}
 
-    QString queryStr = R"(
-        SELECT e.id, e.entry_mood_id, e.entry_date
-        FROM entries e
-        WHERE e.user_login = ?
-          AND TO_CHAR(e.entry_date, 'YYYY-MM') = ?
-        ORDER BY e.entry_date ASC
-    )";
+QList<DailyMoodStats> ComputeDatabase::getDailyMoodStats(const QString &login, const QDate &from, const QDate &to, bool *ok)
+{
+    METRICS_QUERY_SCOPE("ComputeDatabase::getDailyMoodStats");
+    QList<DailyMoodStats> days;
+    if (ok)
+        *ok = false;
 
-    QSqlQuery query;
-    if (!query.prepare(queryStr)) {
-        qWarning() << "Query prepare failed:" << query.lastError().text();
-        return entries;
+    if (login.isEmpty() || !from.isValid() || !to.isValid()) {
+        qWarning() << "Invalid daily stats request:" << login << from << to;
+        return days;
     }
 
-    query.addBindValue(login);
-    query.addBindValue(currentMonth);  // Пример: "2025-05"
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
+        SELECT stat_date, entry_count, mood_sum, mood_min, mood_max, last_mood
+        FROM daily_mood_stats
+        WHERE user_login = :login
+          AND stat_date >= CAST(:from AS date)
+          AND stat_date < CAST(:to AS date)
+        ORDER BY stat_date
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":from", from.toString(Qt::ISODate));
+    query.bindValue(":to", to.toString(Qt::ISODate));
 
     if (!query.exec()) {
-        qWarning() << "Failed to get entries by current month:" << query.lastError().text();
-        return entries;
+        qWarning() << "Failed to get daily mood stats:" << query.lastError().text();
+        return days;
     }
 
     while (query.next()) {
-        int entryId = query.value("id").toInt();
-        int moodId = query.value("entry_mood_id").toInt();
-        QDate date = query.value("entry_date").toDate();
+        DailyMoodStats day;
+        day.date = query.value(0).toDate();
+        day.entryCount = query.value(1).toInt();
+        day.moodSum = query.value(2).toLongLong();
+        day.moodMin = query.value(3).toInt();
+        day.moodMax = query.value(4).toInt();
+        day.lastMood = query.value(5).toInt();
+        days.append(day);
+    }
+
+    if (ok)
+        *ok = true;
+    return days;
+}
+
+QByteArray ComputeDatabase::computeStats(const QString &login, const QDate &from, const QDate &to)
+{
+    METRICS_QUERY_SCOPE("ComputeDatabase::computeStats");
+
+    if (login.isEmpty() || !from.isValid() || !to.isValid() || from > to) {
+        qWarning() << "Invalid stats request:" << login << from << to;
+        return QByteArray();
+    }
+
+    // Всё, кроме распределения, считается по daily_mood_stats (строка на день).
+    // calendar — плотный ряд дней с запасом в 29 дней до начала диапазона,
+    // чтобы окна скользящих средних в первые дни были полными.
+    // Серии дней с записями — «острова»: у подряд идущих дат разность
+    // даты и её номера по порядку одинакова. Обе серии, longest и current,
+    // обрезаются по [from; to]: дни до from в них не входят. current — серия,
+    // которая доходит до to или до вчерашнего для to дня.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
+        WITH params AS (
+            SELECT CAST(:from AS date) AS from_date,
+                   CAST(:to AS date) AS to_date,
+                   CAST(:to AS date) - CAST(:from AS date) + 1 AS period_days
+        ),
+        stats AS (
+            SELECT d.stat_date, d.entry_count, d.mood_sum
+            FROM daily_mood_stats d, params p
+            WHERE d.user_login = :login
+              AND d.stat_date <= p.to_date
+        ),
+        calendar AS (
+            SELECT CAST(g AS date) AS day
+            FROM params p, generate_series(p.from_date - 29, p.to_date, interval '1 day') AS g
+        ),
+        daily AS (
+            SELECT c.day,
+                   COALESCE(s.entry_count, 0) AS entry_count,
+                   COALESCE(s.mood_sum, 0) AS mood_sum
+            FROM calendar c
+            LEFT JOIN stats s ON s.stat_date = c.day
+        ),
+        rolling AS (
+            SELECT day, entry_count, mood_sum,
+                   ROUND(SUM(mood_sum) OVER w7 / NULLIF(SUM(entry_count) OVER w7, 0), 2) AS rolling7,
+                   ROUND(SUM(mood_sum) OVER w30 / NULLIF(SUM(entry_count) OVER w30, 0), 2) AS rolling30
+            FROM daily
+            WINDOW w7 AS (ORDER BY day ROWS BETWEEN 6 PRECEDING AND CURRENT ROW),
+                   w30 AS (ORDER BY day ROWS BETWEEN 29 PRECEDING AND CURRENT ROW)
+        ),
+        weekly AS (
+            SELECT CAST(date_trunc('week', r.day) AS date) AS week_start,
+                   SUM(r.entry_count) AS entry_count,
+                   ROUND(SUM(r.mood_sum) / NULLIF(SUM(r.entry_count), 0), 2) AS average
+            FROM rolling r, params p
+            WHERE r.day >= p.from_date
+            GROUP BY 1
+        ),
+        current_period AS (
+            SELECT COALESCE(SUM(s.entry_count), 0) AS entry_count,
+                   COALESCE(SUM(s.mood_sum), 0) AS mood_sum,
+                   COUNT(*) AS active_days
+            FROM stats s, params p
+            WHERE s.stat_date >= p.from_date
+        ),
+        previous_period AS (
+            SELECT COALESCE(SUM(s.entry_count), 0) AS entry_count,
+                   COALESCE(SUM(s.mood_sum), 0) AS mood_sum,
+                   COUNT(*) AS active_days
+            FROM stats s, params p
+            WHERE s.stat_date >= p.from_date - p.period_days
+              AND s.stat_date < p.from_date
+        ),
+        islands AS (
+            SELECT MIN(stat_date) AS start_date, MAX(stat_date) AS end_date
+            FROM (
+                SELECT stat_date,
+                       stat_date - CAST(ROW_NUMBER() OVER (ORDER BY stat_date) AS integer) AS island
+                FROM stats
+            ) numbered
+            GROUP BY island
+        ),
+        distribution AS (
+            SELECT e.entry_mood_id AS mood_id, COUNT(*) AS entry_count
+            FROM entries e, params p
+            WHERE e.user_login = :login
+              AND e.entry_date >= p.from_date
+              AND e.entry_date <= p.to_date
+              AND e.entry_mood_id IS NOT NULL
+            GROUP BY e.entry_mood_id
+        )
+        SELECT json_build_object(
+            'from', p.from_date,
+            'to', p.to_date,
+            'entryCount', cur.entry_count,
+            'activeDays', cur.active_days,
+            'averageMood', ROUND(cur.mood_sum / NULLIF(cur.entry_count, 0), 2),
+            'distribution', COALESCE((
+                SELECT json_agg(json_build_object('moodId', mood_id, 'count', entry_count) ORDER BY mood_id)
+                FROM distribution), '[]'),
+            'daily', COALESCE((
+                SELECT json_agg(json_build_object(
+                           'date', day,
+                           'count', entry_count,
+                           'average', ROUND(CAST(mood_sum AS numeric) / NULLIF(entry_count, 0), 2),
+                           'rolling7', rolling7,
+                           'rolling30', rolling30) ORDER BY day)
+                FROM rolling
+                WHERE day >= p.from_date), '[]'),
+            'weekly', COALESCE((
+                SELECT json_agg(json_build_object('weekStart', week_start, 'count', entry_count, 'average', average)
+                                ORDER BY week_start)
+                FROM weekly), '[]'),
+            'streaks', json_build_object(
+                'longest', COALESCE((
+                    SELECT MAX(LEAST(end_date, p.to_date) - GREATEST(start_date, p.from_date) + 1)
+                    FROM islands
+                    WHERE end_date >= p.from_date), 0),
+                'current', COALESCE((
+                    SELECT GREATEST(LEAST(end_date, p.to_date) - GREATEST(start_date, p.from_date) + 1, 0)
+                    FROM islands
+                    WHERE end_date >= p.to_date - 1), 0)),
+            'previous', json_build_object(
+                'from', p.from_date - p.period_days,
+                'to', p.from_date - 1,
+                'entryCount', prev.entry_count,
+                'activeDays', prev.active_days,
+                'averageMood', ROUND(prev.mood_sum / NULLIF(prev.entry_count, 0), 2)),
+            'delta', json_build_object(
+                'entryCount', cur.entry_count - prev.entry_count,
+                'activeDays', cur.active_days - prev.active_days,
+                'averageMood', ROUND(cur.mood_sum / NULLIF(cur.entry_count, 0)
+                                     - prev.mood_sum / NULLIF(prev.entry_count, 0), 2))
+        )
+        FROM params p, current_period cur, previous_period prev
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":from", from.toString(Qt::ISODate));
+    query.bindValue(":to", to.toString(Qt::ISODate));
+
+    if (!query.exec() || !query.next()) {
+        qWarning() << "Failed to compute stats:" << query.lastError().text();
+        return QByteArray();
+    }
+
+    return query.value(0).toString().toUtf8();
+}
+
+QByteArray ComputeDatabase::computeStats(const MoodColumns &columns, const QDate &from, const QDate &to)
+{
+    TRACE_SPAN("stats");
+
+    if (!from.isValid() || !to.isValid() || from > to) {
+        qWarning() << "Invalid stats request:" << from << to;
+        return QByteArray();
+    }
+
+    // Плотный ряд дней, как calendar в SQL: с запасом до from на окно в 30 дней
+    // и на предыдущий период такой же длины.
+    const qint64 periodDays = from.daysTo(to) + 1;
+    const QDate first = from.addDays(-qMax<qint64>(29, periodDays));
+    const qint64 firstDay = first.toJulianDay();
+    const qint64 fromDay = from.toJulianDay();
+    const qsizetype dayCount = first.daysTo(to) + 1;
+
+    // Суммы нарастающим итогом: сумма за любое окно — разность двух элементов
+    std::vector<qint64> counts(std::size_t(dayCount) + 1, 0);
+    std::vector<qint64> sums(std::size_t(dayCount) + 1, 0);
+    std::array<int, 256> distribution{};
+    const auto [begin, end] = columns.range(first, to.addDays(1));
+    for (std::size_t i = begin; i < end; ++i) {
+        const int mood = columns.moods[i];
+        const std::size_t day = std::size_t(columns.days[i] - firstDay) + 1;
+        ++counts[day];
+        sums[day] += mood;
+        if (columns.days[i] >= fromDay)
+            ++distribution[std::size_t(mood + 128)];
+    }
+    for (std::size_t i = 1; i < counts.size(); ++i) {
+        counts[i] += counts[i - 1];
+        sums[i] += sums[i - 1];
+    }
+    auto window = [&](qsizetype day, qsizetype length, const std::vector<qint64> &values) {
+        return values[std::size_t(day) + 1] - values[std::size_t(qMax<qsizetype>(day - length + 1, 0))];
+    };
+
+    const qsizetype fromIndex = first.daysTo(from);
+    MoodTotals current;
+    MoodTotals previous;
+    QJsonArray daily;
+    QJsonArray weekly;
+    QDate weekStart;
+    MoodTotals week;
+    int run = 0;
+    int runBefore = 0;
+    int longest = 0;
+
+    auto flushWeek = [&]() {
+        if (!weekStart.isValid())
+            return;
+        QJsonObject obj;
+        obj["weekStart"] = weekStart.toString(Qt::ISODate);
+        obj["count"] = week.entryCount;
+        obj["average"] = roundedRatio(week.moodSum, week.entryCount);
+        weekly.append(obj);
+    };
+
+    for (qsizetype day = fromIndex - periodDays; day < dayCount; ++day) {
+        const qint64 count = window(day, 1, counts);
+        const qint64 sum = window(day, 1, sums);
+        if (day < fromIndex) {
+            previous.add(count, sum);
+            continue;
+        }
+        current.add(count, sum);
+
+        const QDate date = first.addDays(day);
+        QJsonObject obj;
+        obj["date"] = date.toString(Qt::ISODate);
+        obj["count"] = count;
+        obj["average"] = roundedRatio(sum, count);
+        obj["rolling7"] = roundedRatio(window(day, 7, sums), window(day, 7, counts));
+        obj["rolling30"] = roundedRatio(window(day, 30, sums), window(day, 30, counts));
+        daily.append(obj);
+
+        // Неделя с понедельника, как date_trunc('week')
+        const QDate monday = date.addDays(1 - date.dayOfWeek());
+        if (monday != weekStart) {
+            flushWeek();
+            weekStart = monday;
+            week = MoodTotals();
+        }
+        week.add(count, sum);
+
+        // Серии обрезаны по [from; to], поэтому считаются только внутри диапазона
+        runBefore = run;
+        run = count > 0 ? run + 1 : 0;
+        longest = qMax(longest, run);
+    }
+    flushWeek();
+
+    QJsonArray distributionArray;
+    for (int mood = -128; mood < 128; ++mood) {
+        const int count = distribution[std::size_t(mood + 128)];
+        if (count == 0)
+            continue;
+        QJsonObject obj;
+        obj["moodId"] = mood;
+        obj["count"] = count;
+        distributionArray.append(obj);
+    }
+
+    QJsonObject streaks;
+    streaks["longest"] = longest;
+    // серия, которая доходит до to или до вчерашнего для to дня
+    streaks["current"] = run > 0 ? run : runBefore;
+
+    QJsonObject previousObj;
+    previousObj["from"] = from.addDays(-periodDays).toString(Qt::ISODate);
+    previousObj["to"] = from.addDays(-1).toString(Qt::ISODate);
+    previousObj["entryCount"] = previous.entryCount;
+    previousObj["activeDays"] = previous.activeDays;
+    previousObj["averageMood"] = roundedRatio(previous.moodSum, previous.entryCount);
 
-        QString emptyStr;
-        QTime emptyTime;
-        QVector<UserItem> emptyTags;
-        QVector<UserItem> emptyActivities;
-        QVector<UserItem> emptyEmotions;
+    QJsonObject delta;
+    delta["entryCount"] = current.entryCount - previous.entryCount;
+    delta["activeDays"] = current.activeDays - previous.activeDays;
+    // разность средних без промежуточного округления, как в SQL
+    delta["averageMood"] = current.entryCount > 0 && previous.entryCount > 0
+        ? roundedRatio(current.moodSum * previous.entryCount - previous.moodSum * current.entryCount,
+                       current.entryCount * previous.entryCount)
+        : QJsonValue();
 
-        EntryUser entry(entryId, login, emptyStr, emptyStr, moodId, -1, date, emptyTime,
-                        emptyTags, emptyActivities, emptyEmotions);
-        entries.append(entry);
+    QJsonObject result;
+    result["from"] = from.toString(Qt::ISODate);
+    result["to"] = to.toString(Qt::ISODate);
+    result["entryCount"] = current.entryCount;
+    result["activeDays"] = current.activeDays;
+    result["averageMood"] = roundedRatio(current.moodSum, current.entryCount);
+    result["distribution"] = distributionArray;
+    result["daily"] = daily;
+    result["weekly"] = weekly;
+    result["streaks"] = streaks;
+    result["previous"] = previousObj;
+    result["delta"] = delta;
+    return QJsonDocument(result).toJson(QJsonDocument::Compact);
+}
+
+QDate ComputeDatabase::bucketStart(const QDate &date, TimeBucket bucket)
+{
+    switch (bucket) {
+    case TimeBucket::Day:   return date;
+    case TimeBucket::Week:  return date.addDays(1 - date.dayOfWeek());
+    case TimeBucket::Month: return QDate(date.year(), date.month(), 1);
+    case TimeBucket::Year:  return QDate(date.year(), 1, 1);
+    }
+    return date;
+}
+
+QDate ComputeDatabase::nextBucketStart(const QDate &start, TimeBucket bucket)
+{
+    switch (bucket) {
+    case TimeBucket::Day:   return start.addDays(1);
+    case TimeBucket::Week:  return start.addDays(7);
+    case TimeBucket::Month: return start.addMonths(1);
+    case TimeBucket::Year:  return start.addYears(1);
+    }
+    return start.addDays(1);
+}
+
+bool ComputeDatabase::parseBucket(const QString &text, TimeBucket &bucket)
+{
+    const QString name = text.trimmed().toLower();
+    if (name == "day")
+        bucket = TimeBucket::Day;
+    else if (name == "week")
+        bucket = TimeBucket::Week;
+    else if (name == "month")
+        bucket = TimeBucket::Month;
+    else if (name == "year")
+        bucket = TimeBucket::Year;
+    else
+        return false;
+    return true;
+}
+
+QString ComputeDatabase::bucketName(TimeBucket bucket)
+{
+    switch (bucket) {
+    case TimeBucket::Day:   return "day";
+    case TimeBucket::Week:  return "week";
+    case TimeBucket::Month: return "month";
+    case TimeBucket::Year:  return "year";
     }
+    return QString();
+}
 
-    return entries;
+QList<TimeSeriesBucket> ComputeDatabase::emptyBuckets(const QDate &from, const QDate &to, TimeBucket bucket)
+{
+    QList<TimeSeriesBucket> buckets;
+    for (QDate start = bucketStart(from, bucket); start < to; start = nextBucketStart(start, bucket)) {
+        TimeSeriesBucket item;
+        item.start = start;
+        buckets.append(item);
+    }
+    return buckets;
 }
 
+bool ComputeDatabase::monthRange(const QString &month, QDate &start, QDate &end)
+{
+    start = QDate::fromString(month, "yyyy-MM");
+    if (!start.isValid())
+        return false;
+
+    end = start.addMonths(1);
+    return true;
+}
@@ -7,13 +7,79 @@
 #include <QVariant>
 #include <QDebug>
 #include <QString>
+#include <QDate>
 #include "EntryUser.h"
+#include "MoodColumns.h"
+#include "ConnectionPool.h"
+#include "Metrics.h"
+
+// Строка daily_mood_stats: настроение пользователя за один день
+struct DailyMoodStats {
+    QDate date;
+    int entryCount = 0;
+    qint64 moodSum = 0;
+    int moodMin = 0;
+    int moodMax = 0;
+    int lastMood = 0;
+
+    double average() const { return entryCount > 0 ? double(moodSum) / entryCount : 0.0; }
+};
+
+// Шаг временного ряда. Неделя начинается в понедельник, как date_trunc('week').
+enum class TimeBucket {
+    Day,
+    Week,
+    Month,
+    Year
+};
+
+// Интервал ряда [start; следующий start). Заполнено поле того запроса,
+// которым ряд построен: записи или дневная сводка.
+struct TimeSeriesBucket {
+    QDate start;
+    QList<EntryUser> entries;
+    QList<DailyMoodStats> days;
+};
 
 class ComputeDatabase
 {
 public:
-    static QList<EntryUser> getEntriesByLastMonth(const QString &login, const QString &lastMonth);
-    static QList<EntryUser> getEntriesByCurrentMonth(const QString &login, const QString &currentMonth);
+    // Дни с записями в полуоткрытом диапазоне [from; to), по возрастанию даты
+    static QList<DailyMoodStats> getDailyMoodStats(const QString &login, const QDate &from, const QDate &to,
+                                                   bool *ok = nullptr);
+
+    // Ряды за [from; to) одним запросом по диапазону дат. Интервалы идут подряд
+    // от интервала, содержащего from, включая пустые. У записей заполнены
+    // только id, moodId и date.
+    static QList<TimeSeriesBucket> getEntriesSeries(const QString &login, const QDate &from, const QDate &to,
+                                                    TimeBucket bucket, bool *ok = nullptr);
+    static QList<TimeSeriesBucket> getDailyStatsSeries(const QString &login, const QDate &from, const QDate &to,
+                                                       TimeBucket bucket, bool *ok = nullptr);
+
+    // Записи с настроением за [from; to) со связями в колоночном виде;
+    // недействительная граница — без ограничения с этой стороны
+    static MoodColumns loadMoodColumns(const QString &login, const QDate &from, const QDate &to, bool *ok = nullptr);
+    // То же, что getEntriesSeries, но по уже загруженным столбцам, без запроса к базе
+    static QList<TimeSeriesBucket> entriesSeries(const MoodColumns &columns, const QString &login, const QDate &from,
+                                                 const QDate &to, TimeBucket bucket);
+
+    static QDate bucketStart(const QDate &date, TimeBucket bucket);
+    static QDate nextBucketStart(const QDate &start, TimeBucket bucket);
+    // "day" | "week" | "month" | "year"
+    static bool parseBucket(const QString &text, TimeBucket &bucket);
+    static QString bucketName(TimeBucket bucket);
+
+    // Сводная статистика настроения за [from; to] одним запросом, готовый JSON
+    // (см. ComputeManager::handleComputeStats). Пустой QByteArray — ошибка.
+    static QByteArray computeStats(const QString &login, const QDate &from, const QDate &to);
+    // То же по уже загруженной истории пользователя, без запроса к базе
+    static QByteArray computeStats(const MoodColumns &columns, const QDate &from, const QDate &to);
+
+    // "yyyy-MM" -> полуоткрытый диапазон [start; end) для сравнения с entry_date
+    static bool monthRange(const QString &month, QDate &start, QDate &end);
+
+private:
+    static QList<TimeSeriesBucket> emptyBuckets(const QDate &from, const QDate &to, TimeBucket bucket);
 
 };
 
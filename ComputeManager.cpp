@@ -1,9 +1,32 @@
 #include "ComputeManager.h"
 #include "ComputeDatabase.h"
+#include "CategoriesDatabase.h"
+#include "CorrelationEngine.h"
+#include "MoodColumnsCache.h"
+
+// Подробности запросов аналитики по умолчанию не пишутся; включаются через
+// QT_LOGGING_RULES="psqlserver.compute.debug=true".
+Q_LOGGING_CATEGORY(lcCompute, "psqlserver.compute", QtInfoMsg)
+
+QJsonArray ComputeManager::dailyStatsToJson(const QList<DailyMoodStats> &days)
+{
+    QJsonArray array;
+    for (const DailyMoodStats &day : days) {
+        QJsonObject obj;
+        obj["date"] = day.date.toString(Qt::ISODate);
+        obj["count"] = day.entryCount;
+        obj["average"] = day.average();
+        obj["min"] = day.moodMin;
+        obj["max"] = day.moodMax;
+        obj["lastMoodId"] = day.lastMood;
+        array.append(obj);
+    }
+    return array;
+}
 
 QHttpServerResponse ComputeManager::handleLoadEntriesByMonth(const QHttpServerRequest &request)
 {
-    qDebug() << "Запрос на загрузку записей за (прошлый и текущий) месяц вызван!.";
+    qCDebug(lcCompute) << "Запрос на загрузку записей по месяцам вызван.";
 
     if (request.method() != QHttpServerRequest::Method::Post) {
         qWarning() << "Invalid method:" << request.method();
@@ -19,41 +42,297 @@ QHttpServerResponse ComputeManager::handleLoadEntriesByMonth(const QHttpServerRe
 
     QJsonObject obj = doc.object();
     const QString login = obj.value("login").toString();
+
+    if (login.isEmpty()) {
+        qWarning() << "Missing login.";
+        return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    // {"from", "to", "bucket"?}: произвольный диапазон, например год по месяцам
+    if (obj.contains("from")) {
+        QDate from;
+        QDate to;
+        if (!parseRangeStart(obj.value("from").toString(), from) || !parseRangeEnd(obj.value("to").toString(), to)
+            || from >= to) {
+            return QHttpServerResponse("Invalid range", QHttpServerResponse::StatusCode::BadRequest);
+        }
+        if (from.daysTo(to) > MaxRangeDays) {
+            return QHttpServerResponse("Range is too large", QHttpServerResponse::StatusCode::BadRequest);
+        }
+
+        TimeBucket bucket = TimeBucket::Month;
+        if (obj.contains("bucket") && !ComputeDatabase::parseBucket(obj.value("bucket").toString(), bucket)) {
+            return QHttpServerResponse("Invalid bucket", QHttpServerResponse::StatusCode::BadRequest);
+        }
+
+        // По умолчанию — по строке на день из daily_mood_stats: O(дней), а не
+        // O(записей) за весь диапазон. Сами записи — только по summaryOnly: false.
+        const bool summaryOnly = obj.value("summaryOnly").toBool(true);
+
+        qCDebug(lcCompute) << " | Загрузка для пользователя:" << login << "за" << from << "-" << to
+                 << "по" << ComputeDatabase::bucketName(bucket);
+
+        bool ok = false;
+        const QList<TimeSeriesBucket> buckets = summaryOnly
+            ? ComputeDatabase::getDailyStatsSeries(login, from, to, bucket, &ok)
+            : loadEntriesSeries(login, from, to, bucket, &ok);
+        if (!ok) {
+            return QHttpServerResponse("Failed to load entries", QHttpServerResponse::StatusCode::InternalServerError);
+        }
+
+        QJsonArray bucketsArray;
+        for (const TimeSeriesBucket &item : buckets) {
+            QJsonObject bucketObj;
+            bucketObj["start"] = item.start.toString(Qt::ISODate);
+            if (summaryOnly)
+                bucketObj["days"] = dailyStatsToJson(item.days);
+            else
+                bucketObj["entries"] = entriesToJson(item.entries);
+            bucketsArray.append(bucketObj);
+        }
+
+        QJsonObject response;
+        response["bucket"] = ComputeDatabase::bucketName(bucket);
+        response["buckets"] = bucketsArray;
+        return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    }
+
+    // Прежний формат: {"lastMonth", "currentMonth"} — два месяца
     const QString lastMonth = obj.value("lastMonth").toString();
     const QString currentMonth = obj.value("currentMonth").toString();
 
-    if (login.isEmpty() || lastMonth.isEmpty() || currentMonth.isEmpty()) {
+    QDate lastStart, lastEnd, currentStart, currentEnd;
+    if (!ComputeDatabase::monthRange(lastMonth, lastStart, lastEnd)
+        || !ComputeDatabase::monthRange(currentMonth, currentStart, currentEnd)) {
         qWarning() << "Missing login or month values.";
         return QHttpServerResponse("Missing login or month", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    qDebug() << " | Загрузка для пользователя:" << login;
-    qDebug() << " | Прошлый месяц:" << lastMonth << ", текущий месяц:" << currentMonth;
+    // Клиенты прежнего формата разбирают записи, поэтому сводка здесь — только по запросу
+    const bool summaryOnly = obj.value("summaryOnly").toBool(false);
 
-    QList<EntryUser> entriesLast = ComputeDatabase::getEntriesByLastMonth(login, lastMonth);
-    QList<EntryUser> entriesCurrent = ComputeDatabase::getEntriesByCurrentMonth(login, currentMonth);
+    qCDebug(lcCompute) << " | Загрузка для пользователя:" << login;
+    qCDebug(lcCompute) << " | Прошлый месяц:" << lastMonth << ", текущий месяц:" << currentMonth;
 
-    QJsonArray lastArray;
-    for (const EntryUser &entry : entriesLast) {
-        QJsonObject obj;
-        obj["id"] = entry.id;
-        obj["moodId"] = entry.moodId;
-        obj["date"] = entry.date.toString(Qt::ISODate);
-        lastArray.append(obj);
+    // Соседние месяцы (обычный случай) читаются одним запросом
+    auto loadMonths = [&](const QDate &start, const QDate &end, bool *ok) {
+        return summaryOnly
+            ? ComputeDatabase::getDailyStatsSeries(login, start, end, TimeBucket::Month, ok)
+            : loadEntriesSeries(login, start, end, TimeBucket::Month, ok);
+    };
+
+    TimeSeriesBucket last;
+    TimeSeriesBucket current;
+    bool ok = false;
+    if (lastEnd == currentStart) {
+        const QList<TimeSeriesBucket> months = loadMonths(lastStart, currentEnd, &ok);
+        if (ok && months.size() == 2) {
+            last = months[0];
+            current = months[1];
+        }
+    } else {
+        bool currentOk = false;
+        const QList<TimeSeriesBucket> lastMonths = loadMonths(lastStart, lastEnd, &ok);
+        const QList<TimeSeriesBucket> currentMonths = loadMonths(currentStart, currentEnd, &currentOk);
+        ok = ok && currentOk;
+        if (ok) {
+            last = lastMonths.value(0);
+            current = currentMonths.value(0);
+        }
+    }
+    if (!ok) {
+        return QHttpServerResponse("Failed to load entries", QHttpServerResponse::StatusCode::InternalServerError);
     }
 
-    QJsonArray currentArray;
-    for (const EntryUser &entry : entriesCurrent) {
+    QJsonObject response;
+    if (summaryOnly) {
+        response["lastMonthDays"] = dailyStatsToJson(last.days);
+        response["currentMonthDays"] = dailyStatsToJson(current.days);
+    } else {
+        response["lastMonthEntries"] = entriesToJson(last.entries);
+        response["currentMonthEntries"] = entriesToJson(current.entries);
+    }
+
+    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+}
+
+// Записи берутся из колоночного кэша пользователя; без кэша — запросом по диапазону
+QList<TimeSeriesBucket> ComputeManager::loadEntriesSeries(const QString &login, const QDate &from, const QDate &to,
+                                                          TimeBucket bucket, bool *ok)
+{
+    MoodColumnsCache &cache = MoodColumnsCache::instance();
+    if (!cache.isEnabled())
+        return ComputeDatabase::getEntriesSeries(login, from, to, bucket, ok);
+
+    const std::shared_ptr<const MoodColumns> columns = cache.columns(login);
+    *ok = columns != nullptr;
+    if (!columns)
+        return QList<TimeSeriesBucket>();
+    return ComputeDatabase::entriesSeries(*columns, login, from, to, bucket);
+}
+
+QJsonArray ComputeManager::entriesToJson(const QList<EntryUser> &entries)
+{
+    QJsonArray array;
+    for (const EntryUser &entry : entries) {
         QJsonObject obj;
         obj["id"] = entry.id;
         obj["moodId"] = entry.moodId;
         obj["date"] = entry.date.toString(Qt::ISODate);
-        currentArray.append(obj);
+        array.append(obj);
     }
+    return array;
+}
+
+// "yyyy-MM" — с первого дня месяца, "yyyy-MM-dd" — с этого дня
+bool ComputeManager::parseRangeStart(const QString &text, QDate &date)
+{
+    date = text.size() == 7 ? QDate::fromString(text, "yyyy-MM") : QDate::fromString(text, "yyyy-MM-dd");
+    return date.isValid();
+}
+
+// Граница включительная: "yyyy-MM" — по конец месяца, "yyyy-MM-dd" — по этот день.
+// Возвращается день после неё, как конец полуоткрытого диапазона.
+bool ComputeManager::parseRangeEnd(const QString &text, QDate &date)
+{
+    if (text.size() == 7) {
+        date = QDate::fromString(text, "yyyy-MM").addMonths(1);
+    } else {
+        date = QDate::fromString(text, "yyyy-MM-dd").addDays(1);
+    }
+    return date.isValid();
+}
+
+QHttpServerResponse ComputeManager::handleComputeStats(const QHttpServerRequest &request)
+{
+    if (request.method() != QHttpServerRequest::Method::Post) {
+        qWarning() << "Invalid method:" << request.method();
+        return QHttpServerResponse("Invalid method", QHttpServerResponse::StatusCode::MethodNotAllowed);
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(request.body(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "JSON parse error:" << parseError.errorString();
+        return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    const QJsonObject obj = doc.object();
+    const QString login = obj.value("login").toString();
+    const QDate from = QDate::fromString(obj.value("from").toString(), "yyyy-MM-dd");
+    const QDate to = QDate::fromString(obj.value("to").toString(), "yyyy-MM-dd");
+
+    if (login.isEmpty() || !from.isValid() || !to.isValid() || from > to) {
+        qWarning() << "Missing login or invalid range. login:" << login << ", from:" << from << ", to:" << to;
+        return QHttpServerResponse("Missing login or invalid range", QHttpServerResponse::StatusCode::BadRequest);
+    }
+    if (from.daysTo(to) >= MaxRangeDays) {
+        return QHttpServerResponse("Range is too large", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    // История пользователя уже в памяти — считаем по ней; без кэша JSON
+    // собирает PostgreSQL по daily_mood_stats, сервер передаёт его как есть
+    QByteArray stats;
+    MoodColumnsCache &cache = MoodColumnsCache::instance();
+    if (cache.isEnabled()) {
+        if (const std::shared_ptr<const MoodColumns> columns = cache.columns(login))
+            stats = ComputeDatabase::computeStats(*columns, from, to);
+    } else {
+        stats = ComputeDatabase::computeStats(login, from, to);
+    }
+    if (stats.isEmpty()) {
+        return QHttpServerResponse("Failed to compute stats", QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
+    return QHttpServerResponse("application/json", stats);
+}
+
+QHttpServerResponse ComputeManager::handleComputeCorrelations(const QHttpServerRequest &request)
+{
+    if (request.method() != QHttpServerRequest::Method::Post) {
+        qWarning() << "Invalid method:" << request.method();
+        return QHttpServerResponse("Invalid method", QHttpServerResponse::StatusCode::MethodNotAllowed);
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(request.body(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "JSON parse error:" << parseError.errorString();
+        return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    const QJsonObject obj = doc.object();
+    const QString login = obj.value("login").toString();
+    QDate from;
+    QDate to;
+    if (login.isEmpty() || !parseRangeStart(obj.value("from").toString(), from)
+        || !parseRangeEnd(obj.value("to").toString(), to) || from >= to) {
+        return QHttpServerResponse("Missing login or invalid range", QHttpServerResponse::StatusCode::BadRequest);
+    }
+    if (from.daysTo(to) > MaxRangeDays) {
+        return QHttpServerResponse("Range is too large", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    CorrelationEngine::Options options;
+    options.limit = qBound(1, obj.value("limit").toInt(options.limit), 100);
+    options.minCount = qMax(1, obj.value("minCount").toInt(options.minCount));
+
+    CorrelationEngine::Result result;
+    MoodColumnsCache &cache = MoodColumnsCache::instance();
+    if (cache.isEnabled()) {
+        const std::shared_ptr<const MoodColumns> columns = cache.columns(login);
+        if (!columns) {
+            return QHttpServerResponse("Failed to load entries", QHttpServerResponse::StatusCode::InternalServerError);
+        }
+        const auto [first, last] = columns->range(from, to);
+        result = CorrelationEngine::compute(*columns, first, last, options);
+    } else {
+        bool ok = false;
+        const MoodColumns columns = ComputeDatabase::loadMoodColumns(login, from, to, &ok);
+        if (!ok) {
+            return QHttpServerResponse("Failed to load entries", QHttpServerResponse::StatusCode::InternalServerError);
+        }
+        result = CorrelationEngine::compute(columns, 0, columns.size(), options);
+    }
+
+    QJsonArray levels;
+    for (int level : result.moodLevels)
+        levels.append(level);
 
     QJsonObject response;
-    response["lastMonthEntries"] = lastArray;
-    response["currentMonthEntries"] = currentArray;
+    response["entryCount"] = result.entryCount;
+    response["averageMood"] = result.averageMood;
+    response["moodLevels"] = levels;
+    response["activities"] = correlationsToJson(result.activities, CategoriesDatabase::getUserActivities(login));
+    response["emotions"] = correlationsToJson(result.emotions, CategoriesDatabase::getUserEmotions(login));
 
     return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
 }
+
+QJsonArray ComputeManager::correlationsToJson(const QList<CorrelationEngine::Item> &items,
+                                              const QList<CategoriesDatabase::UserItem> &labels)
+{
+    QHash<int, const CategoriesDatabase::UserItem *> byId;
+    for (const CategoriesDatabase::UserItem &label : labels)
+        byId.insert(label.id, &label);
+
+    QJsonArray array;
+    for (const CorrelationEngine::Item &item : items) {
+        QJsonObject obj;
+        obj["id"] = item.id;
+        if (const CategoriesDatabase::UserItem *label = byId.value(item.id)) {
+            obj["label"] = label->label;
+            obj["iconId"] = label->iconId;
+        }
+        obj["count"] = item.count;
+        obj["averageMood"] = item.averageMood;
+        obj["lift"] = item.lift;
+
+        QJsonArray moodCounts;
+        for (int count : item.moodCounts)
+            moodCounts.append(count);
+        obj["moodCounts"] = moodCounts;
+        array.append(obj);
+    }
+    return array;
+}
@@ -12,14 +12,40 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <QLoggingCategory>
 #include "EntryUser.h"
+#include "ComputeDatabase.h"
+#include "CategoriesDatabase.h"
+#include "CorrelationEngine.h"
 
 class ComputeManager
 {
 
 public:
     ComputeManager() = default;
+    // {"login", "lastMonth", "currentMonth"} — два месяца, как раньше;
+    // {"login", "from", "to", "bucket"?} — любой диапазон с шагом day/week/month/year.
+    // summaryOnly — дневная сводка вместо записей; по умолчанию true для from/to
+    // и false для прежнего формата, клиенты которого ждут записи.
     QHttpServerResponse handleLoadEntriesByMonth(const QHttpServerRequest &request);
+    // {"login", "from", "to"} -> распределение, средние по дням и неделям,
+    // скользящие средние за 7/30 дней, серии и сравнение с предыдущим периодом
+    QHttpServerResponse handleComputeStats(const QHttpServerRequest &request);
+    // {"login", "from", "to", "limit"?, "minCount"?} -> активности и эмоции,
+    // сильнее всего связанные с настроением (см. CorrelationEngine)
+    QHttpServerResponse handleComputeCorrelations(const QHttpServerRequest &request);
+
+private:
+    static constexpr int MaxRangeDays = 3 * 366;
+
+    static QJsonArray dailyStatsToJson(const QList<DailyMoodStats> &days);
+    static QJsonArray entriesToJson(const QList<EntryUser> &entries);
+    static QList<TimeSeriesBucket> loadEntriesSeries(const QString &login, const QDate &from, const QDate &to,
+                                                     TimeBucket bucket, bool *ok);
+    static bool parseRangeStart(const QString &text, QDate &date);
+    static bool parseRangeEnd(const QString &text, QDate &date);
+    static QJsonArray correlationsToJson(const QList<CorrelationEngine::Item> &items,
+                                         const QList<CategoriesDatabase::UserItem> &labels);
 
 };
 
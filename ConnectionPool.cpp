@@ -0,0 +1,277 @@
+#include "ConnectionPool.h"
+
+#include <QDeadlineTimer>
+
+ConnectionPool &ConnectionPool::instance()
+{
+    // Пул живёт до конца процесса: соединения рабочих потоков закрываются
+    // при завершении потока, и пул к этому моменту должен ещё существовать.
+    static ConnectionPool *pool = new ConnectionPool;
+    return *pool;
+}
+
+void ConnectionPool::configure(const Config &config)
+{
+    QMutexLocker locker(&m_mutex);
+    m_config = config;
+    if (m_config.maxConnections < 1)
+        m_config.maxConnections = 1;
+}
+
+ConnectionPool::Config ConnectionPool::config() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_config;
+}
+
+ConnectionPool::ThreadConnection::~ThreadConnection()
+{
+    ConnectionPool &pool = ConnectionPool::instance();
+    if (depth > 0) {
+        QMutexLocker locker(&pool.m_mutex);
+        --pool.m_stats.inUse;
+    }
+    pool.closeConnection(this);
+}
+
+ConnectionPool::ThreadConnection *ConnectionPool::localConnection()
+{
+    if (!m_connections.hasLocalData())
+        m_connections.setLocalData(new ThreadConnection);
+    return m_connections.localData();
+}
+
+QSqlDatabase ConnectionPool::checkout()
+{
+    ThreadConnection *slot = localConnection();
+
+    if (slot->depth > 0) {
+        ++slot->depth;
+        return slot->db;
+    }
+
+    if (slot->db.isValid() && !isHealthy(slot)) {
+        qWarning() << "Connection" << slot->name << "failed health check, reconnecting.";
+        closeConnection(slot);
+        QMutexLocker locker(&m_mutex);
+        ++m_stats.reconnects;
+    }
+
+    if (!slot->db.isValid() && !openConnection(slot))
+        return QSqlDatabase();
+
+    slot->depth = 1;
+
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.inUse;
+    ++m_stats.checkouts;
+    return slot->db;
+}
+
+void ConnectionPool::checkin()
+{
+    if (!m_connections.hasLocalData())
+        return;
+
+    ThreadConnection *slot = m_connections.localData();
+    if (slot->depth <= 0 || --slot->depth > 0)
+        return;
+
+    slot->lastUsed.start();
+
+    QMutexLocker locker(&m_mutex);
+    --m_stats.inUse;
+}
+
+bool ConnectionPool::warmUp()
+{
+    PooledConnection connection;
+    return connection.isValid();
+}
+
+QSqlQuery *ConnectionPool::statement(const QString &sql)
+{
+    ThreadConnection *slot = localConnection();
+    if (!slot->db.isValid())
+        return nullptr;
+
+    auto it = slot->statements.find(sql);
+    if (it != slot->statements.end() && (*it)->inUse)
+        return nullptr;
+    if (it != slot->statements.end() && (*it)->prepared) {
+        m_statementHits.fetch_add(1, std::memory_order_relaxed);
+        (*it)->inUse = true;
+        return &(*it)->query;
+    }
+
+    m_statementMisses.fetch_add(1, std::memory_order_relaxed);
+
+    if (it == slot->statements.end()) {
+        int maxCachedStatements;
+        {
+            QMutexLocker locker(&m_mutex);
+            maxCachedStatements = m_config.maxCachedStatements;
+        }
+        // Вытеснять нельзя: запросы из кэша могут быть ещё в работе выше по стеку.
+        // Текст SQL почти всегда постоянный, так что предел — страховка.
+        if (slot->statements.size() >= maxCachedStatements)
+            return nullptr;
+        it = slot->statements.insert(sql, new CachedStatement(slot->db));
+    }
+
+    // все *Database функции читают результат только через next()
+    CachedStatement *cached = *it;
+    cached->query.setForwardOnly(true);
+    cached->prepared = cached->query.prepare(sql);
+    if (!cached->prepared)
+        qWarning() << "Failed to prepare statement:" << cached->query.lastError().text();
+    cached->inUse = true;
+    return &cached->query;
+}
+
+void ConnectionPool::releaseStatement(const QString &sql)
+{
+    ThreadConnection *slot = localConnection();
+    const auto it = slot->statements.constFind(sql);
+    if (it == slot->statements.constEnd())
+        return;
+
+    (*it)->query.finish();
+    (*it)->inUse = false;
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats stats = m_stats;
+    stats.statementHits = m_statementHits.load(std::memory_order_relaxed);
+    stats.statementMisses = m_statementMisses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ConnectionPool::openConnection(ThreadConnection *slot)
+{
+    Config config;
+    {
+        QMutexLocker locker(&m_mutex);
+        QDeadlineTimer deadline(m_config.acquireTimeoutMs);
+        while (m_stats.open >= m_config.maxConnections) {
+            ++m_stats.waits;
+            if (!m_released.wait(&m_mutex, deadline)) {
+                ++m_stats.failures;
+                qWarning() << "Connection pool exhausted:" << m_stats.open
+                           << "of" << m_config.maxConnections << "connections are open.";
+                return false;
+            }
+        }
+        ++m_stats.open;
+        m_stats.peak = qMax(m_stats.peak, m_stats.open);
+        config = m_config;
+        if (slot->name.isEmpty())
+            slot->name = QString("psql_%1").arg(m_nextId++);
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(config.driver, slot->name);
+    db.setHostName(config.hostName);
+    db.setPort(config.port);
+    db.setDatabaseName(config.databaseName);
+    db.setUserName(config.userName);
+    db.setPassword(config.password);
+
+    if (!db.open()) {
+        qCritical() << "Failed to open pooled connection" << slot->name << ":" << db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(slot->name);
+
+        QMutexLocker locker(&m_mutex);
+        --m_stats.open;
+        ++m_stats.failures;
+        m_released.wakeOne();
+        return false;
+    }
+
+    slot->db = db;
+    slot->lastUsed.start();
+    slot->lastHealthCheck.start();
+    return true;
+}
+
+void ConnectionPool::closeConnection(ThreadConnection *slot)
+{
+    if (!slot->db.isValid())
+        return;
+
+    // подготовленные запросы должны быть удалены до закрытия соединения
+    qDeleteAll(slot->statements);
+    slot->statements.clear();
+
+    slot->db.close();
+    slot->db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(slot->name);
+
+    QMutexLocker locker(&m_mutex);
+    --m_stats.open;
+    m_released.wakeOne();
+}
+
+bool ConnectionPool::isHealthy(ThreadConnection *slot)
+{
+    if (!slot->db.isOpen())
+        return false;
+
+    int healthCheckIntervalMs;
+    int idleTimeoutMs;
+    {
+        QMutexLocker locker(&m_mutex);
+        healthCheckIntervalMs = m_config.healthCheckIntervalMs;
+        idleTimeoutMs = m_config.idleTimeoutMs;
+    }
+
+    const bool idleTooLong = slot->lastUsed.isValid() && slot->lastUsed.hasExpired(idleTimeoutMs);
+    const bool checkDue = !slot->lastHealthCheck.isValid() || slot->lastHealthCheck.hasExpired(healthCheckIntervalMs);
+    if (!idleTooLong && !checkDue)
+        return true;
+
+    bool ok;
+    {
+        QSqlQuery ping(slot->db);
+        ok = ping.exec("SELECT 1");
+        if (!ok)
+            qWarning() << "Health check failed for" << slot->name << ":" << ping.lastError().text();
+    }
+    slot->lastHealthCheck.start();
+    return ok;
+}
+
+PooledConnection::PooledConnection()
+    : m_db(ConnectionPool::instance().checkout())
+{
+}
+
+PooledConnection::~PooledConnection()
+{
+    ConnectionPool &pool = ConnectionPool::instance();
+    for (auto it = m_cached.cbegin(); it != m_cached.cend(); ++it)
+        pool.releaseStatement(it.key());
+    m_uncached.clear();
+
+    if (m_db.isValid())
+        ConnectionPool::instance().checkin();
+}
+
+QSqlQuery &PooledConnection::prepared(const QString &sql)
+{
+    // повторный вызов в той же области видимости — тот же запрос
+    if (QSqlQuery *query = m_cached.value(sql))
+        return *query;
+
+    if (QSqlQuery *query = ConnectionPool::instance().statement(sql)) {
+        m_cached.insert(sql, query);
+        return *query;
+    }
+
+    QSqlQuery &query = m_uncached.emplace_back(m_db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    return query;
+}
@@ -0,0 +1,139 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadStorage>
+#include <QElapsedTimer>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QDebug>
+#include <atomic>
+#include <list>
+
+// Пул соединений с PostgreSQL.
+// QSqlDatabase можно использовать только из потока, который его открыл,
+// поэтому каждый поток получает собственное именованное соединение
+// ("psql_<n>"), а пул ограничивает их общее количество.
+// Закрыть соединение можно только из его потока, поэтому отдельного
+// вытеснения простаивающих соединений нет: соединение закрывается вместе
+// с потоком, а рабочие потоки завершаются после простоя
+// (RequestExecutor::Config::expiryTimeoutMs).
+class ConnectionPool
+{
+public:
+    struct Config {
+        QString driver = "QPSQL";
+        QString hostName = "localhost";
+        int port = 5432;
+        QString databaseName;
+        QString userName;
+        QString password;
+        int maxConnections = 16;            // больше соединений одновременно не открывается
+        int idleTimeoutMs = 5 * 60 * 1000;  // простаивающее дольше соединение перепроверяется
+        int healthCheckIntervalMs = 30 * 1000;
+        int acquireTimeoutMs = 5000;        // сколько ждать свободного места в пуле
+        int maxCachedStatements = 128;      // подготовленных запросов на одно соединение
+    };
+
+    struct Stats {
+        int open = 0;
+        int inUse = 0;
+        int peak = 0;
+        quint64 checkouts = 0;
+        quint64 waits = 0;
+        quint64 reconnects = 0;
+        quint64 failures = 0;
+        quint64 statementHits = 0;
+        quint64 statementMisses = 0;
+    };
+
+    static ConnectionPool &instance();
+
+    void configure(const Config &config);
+    Config config() const;
+
+    // Выдаёт соединение текущего потока, открывая его при первом обращении.
+    // Вложенные checkout() в одном потоке возвращают то же соединение,
+    // поэтому транзакция видна всем *Database функциям внутри неё.
+    QSqlDatabase checkout();
+    void checkin();
+
+    // Подготовленный запрос соединения текущего потока с данным текстом SQL.
+    // PREPARE выполняется на сервере один раз, дальше запрос переиспользуется,
+    // пока соединение не закроется. Запрос занят до releaseStatement().
+    // nullptr — кэш заполнен, соединения нет или запрос уже занят выше по стеку.
+    QSqlQuery *statement(const QString &sql);
+    void releaseStatement(const QString &sql);
+
+    // Открывает соединение текущего потока, чтобы проверить настройки при старте
+    bool warmUp();
+    Stats stats() const;
+
+private:
+    struct CachedStatement {
+        explicit CachedStatement(const QSqlDatabase &db) : query(db) {}
+
+        QSqlQuery query;
+        bool prepared = false;
+        bool inUse = false;     // результат ещё читает какой-то PooledConnection
+    };
+
+    struct ThreadConnection {
+        QString name;
+        QSqlDatabase db;
+        int depth = 0;
+        QElapsedTimer lastUsed;
+        QElapsedTimer lastHealthCheck;
+        QHash<QString, CachedStatement *> statements;
+
+        ~ThreadConnection();
+    };
+
+    ConnectionPool() = default;
+    Q_DISABLE_COPY(ConnectionPool)
+
+    ThreadConnection *localConnection();
+    bool openConnection(ThreadConnection *slot);
+    void closeConnection(ThreadConnection *slot);
+    bool isHealthy(ThreadConnection *slot);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_released;
+    Config m_config;
+    Stats m_stats;
+    int m_nextId = 0;
+    QThreadStorage<ThreadConnection *> m_connections;
+    std::atomic<quint64> m_statementHits{0};
+    std::atomic<quint64> m_statementMisses{0};
+};
+
+// RAII-обёртка: берёт соединение из пула и возвращает его при выходе из области видимости.
+class PooledConnection
+{
+public:
+    PooledConnection();
+    ~PooledConnection();
+
+    QSqlDatabase database() const { return m_db; }
+    bool isValid() const { return m_db.isValid() && m_db.isOpen(); }
+
+    // Запрос из кэша подготовленных запросов соединения. Ссылка действительна
+    // до разрушения PooledConnection; тогда же результат освобождается (finish()).
+    // Значения привязываются заново при каждом вызове. Если тот же SQL ещё
+    // читается во внешнем PooledConnection, выдаётся отдельный запрос, чтобы
+    // не сбросить чужой результат.
+    QSqlQuery &prepared(const QString &sql);
+
+private:
+    Q_DISABLE_COPY(PooledConnection)
+    QSqlDatabase m_db;
+    QHash<QString, QSqlQuery *> m_cached;
+    std::list<QSqlQuery> m_uncached;
+};
+
+#endif // CONNECTIONPOOL_H
@@ -0,0 +1,109 @@
+#include "CorrelationEngine.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+CorrelationEngine::Result CorrelationEngine::compute(const MoodColumns &columns, std::size_t first, std::size_t last,
+                                                     const Options &options)
+{
+    TRACE_SPAN("correlate");
+
+    Result result;
+    last = qMin(last, columns.size());
+    if (first >= last)
+        return result;
+
+    // Уровни настроения: int8 -> плотный индекс столбца матрицы
+    std::vector<int> moodIndex(256, -1);
+    qint64 totalMood = 0;
+    for (std::size_t i = first; i < last; ++i) {
+        const int mood = columns.moods[i];
+        moodIndex[std::size_t(mood + 128)] = 0;
+        totalMood += mood;
+    }
+    int moodLevelCount = 0;
+    for (int value = -128; value < 128; ++value) {
+        int &index = moodIndex[std::size_t(value + 128)];
+        if (index < 0)
+            continue;
+        index = moodLevelCount++;
+        result.moodLevels.append(value);
+    }
+
+    result.entryCount = int(last - first);
+    result.averageMood = double(totalMood) / result.entryCount;
+    result.activities = correlate(columns, first, last, columns.activityOffsets, columns.activityIds,
+                                  moodIndex, moodLevelCount, totalMood, options);
+    result.emotions = correlate(columns, first, last, columns.emotionOffsets, columns.emotionIds,
+                                moodIndex, moodLevelCount, totalMood, options);
+    return result;
+}
+
+QList<CorrelationEngine::Item> CorrelationEngine::correlate(const MoodColumns &columns, std::size_t first, std::size_t last,
+                                                           const std::vector<quint32> &offsets, const std::vector<qint32> &ids,
+                                                           const std::vector<int> &moodIndex, int moodLevelCount,
+                                                           qint64 totalMood, const Options &options)
+{
+    const std::size_t begin = offsets[first];
+    const std::size_t end = offsets[last];
+    if (begin == end)
+        return QList<Item>();
+
+    // Идентификаторы -> плотные индексы 0..K-1 одним проходом по отсортированным ключам
+    std::vector<qint32> keys(ids.cbegin() + std::ptrdiff_t(begin), ids.cbegin() + std::ptrdiff_t(end));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<int> dense(end - begin);
+    for (std::size_t r = begin; r < end; ++r)
+        dense[r - begin] = int(std::lower_bound(keys.cbegin(), keys.cend(), ids[r]) - keys.cbegin());
+
+    const std::size_t itemCount = keys.size();
+    std::vector<int> counts(itemCount, 0);
+    std::vector<qint64> sums(itemCount, 0);
+    std::vector<int> matrix(itemCount * std::size_t(moodLevelCount), 0);
+
+    for (std::size_t i = first; i < last; ++i) {
+        const int mood = columns.moods[i];
+        const int level = moodIndex[std::size_t(mood + 128)];
+        for (std::size_t r = offsets[i]; r < offsets[i + 1]; ++r) {
+            const int k = dense[r - begin];
+            ++counts[k];
+            sums[k] += mood;
+            ++matrix[std::size_t(k) * std::size_t(moodLevelCount) + std::size_t(level)];
+        }
+    }
+
+    const int entryCount = int(last - first);
+    QList<Item> items;
+    for (std::size_t k = 0; k < itemCount; ++k) {
+        if (counts[k] < options.minCount)
+            continue;
+
+        Item item;
+        item.id = keys[k];
+        item.count = counts[k];
+        item.averageMood = double(sums[k]) / counts[k];
+        const int without = entryCount - counts[k];
+        if (without > 0)
+            item.lift = item.averageMood - double(totalMood - sums[k]) / without;
+
+        const int *row = matrix.data() + k * std::size_t(moodLevelCount);
+        item.moodCounts.reserve(moodLevelCount);
+        for (int level = 0; level < moodLevelCount; ++level)
+            item.moodCounts.append(row[level]);
+        items.append(item);
+    }
+
+    std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
+        const double liftA = std::abs(a.lift);
+        const double liftB = std::abs(b.lift);
+        if (liftA != liftB)
+            return liftA > liftB;
+        return a.count > b.count;
+    });
+    if (options.limit > 0 && items.size() > options.limit)
+        items.resize(options.limit);
+    return items;
+}
@@ -0,0 +1,48 @@
+#ifndef CORRELATIONENGINE_H
+#define CORRELATIONENGINE_H
+
+#include <QList>
+#include <vector>
+#include "MoodColumns.h"
+
+// Связь активностей и эмоций с настроением.
+// Для каждого элемента считается число записей с ним, среднее настроение
+// этих записей и «подъём» — разница со средним настроением записей без него,
+// а также матрица совместной встречаемости элемент × уровень настроения.
+// Идентификаторы заранее переводятся в плотные индексы, поэтому внутренний
+// цикл идёт только по массивам целых.
+class CorrelationEngine
+{
+public:
+    struct Options {
+        int limit = 10;         // элементов каждого вида в ответе
+        int minCount = 3;       // элементы с меньшим числом записей шумят и отбрасываются
+    };
+
+    struct Item {
+        int id = 0;
+        int count = 0;
+        double averageMood = 0.0;
+        double lift = 0.0;
+        QList<int> moodCounts;  // по уровням Result::moodLevels
+    };
+
+    struct Result {
+        int entryCount = 0;
+        double averageMood = 0.0;
+        QList<int> moodLevels;  // встречающиеся значения настроения по возрастанию
+        QList<Item> activities; // по убыванию |lift|
+        QList<Item> emotions;
+    };
+
+    // Записи [first; last) из columns
+    static Result compute(const MoodColumns &columns, std::size_t first, std::size_t last, const Options &options);
+
+private:
+    static QList<Item> correlate(const MoodColumns &columns, std::size_t first, std::size_t last,
+                                 const std::vector<quint32> &offsets, const std::vector<qint32> &ids,
+                                 const std::vector<int> &moodIndex, int moodLevelCount,
+                                 qint64 totalMood, const Options &options);
+};
+
+#endif // CORRELATIONENGINE_H
@@ -0,0 +1,118 @@
+#include "DataVersions.h"
+
+#include <QDateTime>
+#include <QHttpHeaders>
+#include <QList>
+
+QReadWriteLock DataVersions::s_lock;
+QHash<QString, DataVersions::UserVersions *> DataVersions::s_users;
+
+namespace {
+
+QByteArrayView opaqueTag(QByteArrayView tag)
+{
+    tag = tag.trimmed();
+    if (tag.startsWith("W/"))
+        tag = tag.sliced(2);
+    return tag;
+}
+
+} // namespace
+
+quint64 DataVersions::version(const QString &login, Collection collection)
+{
+    const UserVersions *user = find(login);
+    if (!user)
+        return 0;
+    return user->versions[std::size_t(collection)].load(std::memory_order_acquire);
+}
+
+void DataVersions::bump(const QString &login, Collection collection)
+{
+    findOrCreate(login)->versions[std::size_t(collection)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void DataVersions::bump(const QString &login, std::initializer_list<Collection> collections)
+{
+    UserVersions *user = findOrCreate(login);
+    for (Collection collection : collections)
+        user->versions[std::size_t(collection)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void DataVersions::bumpAll(const QString &login)
+{
+    UserVersions *user = findOrCreate(login);
+    for (std::atomic<quint64> &version : user->versions)
+        version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+QByteArray DataVersions::etag(const QString &login, Collection collection)
+{
+    QByteArray tag = "W/\"";
+    tag.append(epoch()).append('-');
+    tag.append(QByteArray::number(int(collection))).append('-');
+    tag.append(QByteArray::number(version(login, collection))).append('"');
+    return tag;
+}
+
+bool DataVersions::isNotModified(const QHttpServerRequest &request, const QByteArray &etag)
+{
+    const QByteArray header = request.headers().combinedValue(QHttpHeaders::WellKnownHeader::IfNoneMatch);
+    if (header.isEmpty())
+        return false;
+
+    // GET сравнивает теги слабо (RFC 9110, 13.1.2): префикс W/ не учитывается
+    const QByteArrayView expected = opaqueTag(etag);
+    const QList<QByteArray> candidates = header.split(',');
+    for (const QByteArray &candidate : candidates) {
+        if (candidate.trimmed() == "*" || opaqueTag(candidate) == expected)
+            return true;
+    }
+    return false;
+}
+
+QHttpServerResponse DataVersions::notModified(const QByteArray &etag)
+{
+    QHttpServerResponse response(QHttpServerResponse::StatusCode::NotModified);
+    setETag(response, etag);
+    return response;
+}
+
+void DataVersions::setETag(QHttpServerResponse &response, const QByteArray &etag)
+{
+    QHttpHeaders headers = response.headers();
+    headers.replaceOrAppend(QHttpHeaders::WellKnownHeader::ETag, etag);
+    // клиент может хранить ответ, но обязан перепроверять его при каждом открытии экрана
+    headers.replaceOrAppend(QHttpHeaders::WellKnownHeader::CacheControl, "private, no-cache");
+    response.setHeaders(std::move(headers));
+}
+
+DataVersions::UserVersions *DataVersions::find(const QString &login)
+{
+    QReadLocker locker(&s_lock);
+    return s_users.value(login.trimmed(), nullptr);
+}
+
+DataVersions::UserVersions *DataVersions::findOrCreate(const QString &login)
+{
+    const QString key = login.trimmed();
+    {
+        QReadLocker locker(&s_lock);
+        if (UserVersions *user = s_users.value(key, nullptr))
+            return user;
+    }
+
+    // Записи не удаляются: указатель остаётся действительным без блокировки,
+    // а на пользователя уходит несколько десятков байт.
+    QWriteLocker locker(&s_lock);
+    UserVersions *&user = s_users[key];
+    if (!user)
+        user = new UserVersions;
+    return user;
+}
+
+const QByteArray &DataVersions::epoch()
+{
+    static const QByteArray value = QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 36);
+    return value;
+}
@@ -0,0 +1,60 @@
+#ifndef DATAVERSIONS_H
+#define DATAVERSIONS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QHttpServerRequest>
+#include <QHttpServerResponse>
+#include <array>
+#include <atomic>
+#include <initializer_list>
+
+// Версии пользовательских данных для условных GET-запросов.
+// Каждая успешная запись в *Database функциях увеличивает версию
+// затронутых коллекций пользователя; ETag ответа строится из версии,
+// поэтому If-None-Match проверяется без обращения к базе.
+class DataVersions
+{
+public:
+    enum class Collection {
+        Tags,
+        Activities,
+        Emotions,
+        Folders,
+        Todos,
+        Entries
+    };
+    static constexpr int CollectionCount = 6;
+
+    static quint64 version(const QString &login, Collection collection);
+    static void bump(const QString &login, Collection collection);
+    // для записей, меняющих сразу несколько ответов (удалённый тег пропадает и из записей)
+    static void bump(const QString &login, std::initializer_list<Collection> collections);
+    static void bumpAll(const QString &login);
+
+    // Слабый ETag: W/"<эпоха процесса>-<коллекция>-<версия>". Эпоха меняется
+    // при перезапуске, так что версии, начатые заново с нуля, не совпадут со старыми.
+    // Обработчик берёт тег до запроса к базе: запись, успевшая между ними, даст
+    // клиенту более свежие данные со старым тегом и лишь лишний повторный запрос.
+    static QByteArray etag(const QString &login, Collection collection);
+
+    static bool isNotModified(const QHttpServerRequest &request, const QByteArray &etag);
+    static QHttpServerResponse notModified(const QByteArray &etag);
+    static void setETag(QHttpServerResponse &response, const QByteArray &etag);
+
+private:
+    struct UserVersions {
+        std::array<std::atomic<quint64>, CollectionCount> versions{};
+    };
+
+    static UserVersions *find(const QString &login);
+    static UserVersions *findOrCreate(const QString &login);
+    static const QByteArray &epoch();
+
+    static QReadWriteLock s_lock;
+    static QHash<QString, UserVersions *> s_users;
+};
+
+#endif // DATAVERSIONS_H
@@ -1,18 +1,179 @@
 #include "Database.h"
+#include "ConnectionPool.h"
 
 
-bool Database::connect() {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QPSQL");
-    db.setHostName("localhost");
-    db.setDatabaseName("MindTraceMainDB");
-    db.setUserName("postgres");  // замените на нужное имя пользователя
-    db.setPassword("123");
+bool Database::connect(int maxConnections) {
+    ConnectionPool::Config config;
+    config.hostName = "localhost";
+    config.databaseName = "MindTraceMainDB";
+    config.userName = "postgres";  // замените на нужное имя пользователя
+    config.password = "123";
+    config.maxConnections = maxConnections;
 
-    if (!db.open()) {
-        qCritical() << "Failed to connect to database:" << db.lastError().text();
+    ConnectionPool &pool = ConnectionPool::instance();
+    pool.configure(config);
+
+    // Открываем соединение главного потока сразу, чтобы ошибка в настройках
+    // была видна при старте, а не на первом запросе.
+    if (!pool.warmUp()) {
+        qCritical() << "Failed to connect to database.";
         return false;
     }
 
     qInfo() << "Successfully connected to database.";
     return true;
 }
+
+bool Database::ensureSchema()
+{
+    static const char *const statements[] = {
+        // Полнотекстовый поиск по записям: заголовок важнее текста,
+        // из текста убираются HTML-теги и сущности.
+        R"(
+            ALTER TABLE entries ADD COLUMN IF NOT EXISTS entry_search tsvector
+            GENERATED ALWAYS AS (
+                setweight(to_tsvector('russian', coalesce(entry_title, '')), 'A') ||
+                setweight(to_tsvector('russian',
+                    regexp_replace(
+                        regexp_replace(coalesce(entry_content, ''), '<[^>]*>', ' ', 'g'),
+                        '&[#a-zA-Z0-9]+;', ' ', 'g')), 'B')
+            ) STORED
+        )",
+        R"(
+            CREATE INDEX IF NOT EXISTS entries_search_idx
+            ON entries USING GIN (entry_search)
+        )",
+        // entry_time входит в ключ keyset-пагинации, поэтому он не может быть NULL
+        // (сравнение строк с NULL не даёт true, и такие записи выпадали бы из
+        // страниц) и хранится с точностью QTime — до миллисекунд, как в курсоре.
+        // Таблица переписывается один раз, на следующих запусках блок ничего не делает.
+        R"(
+            DO $$
+            BEGIN
+                IF EXISTS (SELECT 1 FROM information_schema.columns
+                           WHERE table_schema = current_schema() AND table_name = 'entries'
+                             AND column_name = 'entry_time'
+                             AND (is_nullable = 'YES' OR datetime_precision IS DISTINCT FROM 3)) THEN
+                    ALTER TABLE entries
+                        ALTER COLUMN entry_time TYPE time(3) USING COALESCE(entry_time, TIME '00:00'),
+                        ALTER COLUMN entry_time SET DEFAULT TIME '00:00',
+                        ALTER COLUMN entry_time SET NOT NULL;
+                END IF;
+            END
+            $$
+        )",
+        // Выборки за месяц по папке и keyset-пагинация по (entry_date, entry_time, id).
+        R"(
+            CREATE INDEX IF NOT EXISTS entries_user_folder_date_idx
+            ON entries (user_login, entry_folder_id, entry_date, entry_time, id)
+        )",
+        // Поиск по дате, настроение за день и статистика по диапазону дат.
+        R"(
+            CREATE INDEX IF NOT EXISTS entries_user_date_idx
+            ON entries (user_login, entry_date, entry_time, id)
+        )",
+        // Сводка настроения по дням: статистика читает O(дней) строк вместо O(записей).
+        // Поддерживается в тех же транзакциях, что меняют entries (см. EntriesDatabase).
+        // "Последняя" запись дня — наибольшая по (entry_time, id).
+        R"(
+            CREATE TABLE IF NOT EXISTS daily_mood_stats (
+                user_login text NOT NULL,
+                stat_date date NOT NULL,
+                entry_count integer NOT NULL,
+                mood_sum bigint NOT NULL,
+                mood_min integer NOT NULL,
+                mood_max integer NOT NULL,
+                last_mood integer NOT NULL,
+                last_time time NOT NULL,
+                last_entry_id integer NOT NULL,
+                PRIMARY KEY (user_login, stat_date)
+            )
+        )",
+        // Заполнение по уже существующим записям; после первого запуска таблица
+        // не пуста и полный проход не повторяется.
+        R"(
+            INSERT INTO daily_mood_stats (user_login, stat_date, entry_count, mood_sum, mood_min, mood_max,
+                                          last_mood, last_time, last_entry_id)
+            SELECT user_login, entry_date, COUNT(*), SUM(entry_mood_id), MIN(entry_mood_id), MAX(entry_mood_id),
+                   (ARRAY_AGG(entry_mood_id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1],
+                   MAX(COALESCE(entry_time, TIME '00:00')),
+                   (ARRAY_AGG(id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1]
+            FROM entries
+            WHERE entry_mood_id IS NOT NULL
+              AND NOT EXISTS (SELECT 1 FROM daily_mood_stats)
+            GROUP BY user_login, entry_date
+        )",
+    };
+
+    PooledConnection connection;
+    bool ok = true;
+    for (const char *statement : statements) {
+        QSqlQuery query(connection.database());
+        if (!query.exec(statement)) {
+            qCritical() << "Schema update failed:" << query.lastError().text();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+QString Database::toIntArray(const QList<int> &ids)
+{
+    QString result;
+    result.reserve(ids.size() * 6 + 2);
+    result += QLatin1Char('{');
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        if (i > 0)
+            result += QLatin1Char(',');
+        result += QString::number(ids[i]);
+    }
+    result += QLatin1Char('}');
+    return result;
+}
+
+QString Database::toTextArray(const QStringList &values)
+{
+    QString result;
+    result += QLatin1Char('{');
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        if (i > 0)
+            result += QLatin1Char(',');
+        result += QLatin1Char('"');
+        for (const QChar c : values[i]) {
+            if (c == QLatin1Char('"') || c == QLatin1Char('\\'))
+                result += QLatin1Char('\\');
+            result += c;
+        }
+        result += QLatin1Char('"');
+    }
+    result += QLatin1Char('}');
+    return result;
+}
+
+DatabaseTransaction::DatabaseTransaction(const QSqlDatabase &db)
+    : m_db(db)
+{
+    m_active = m_db.transaction();
+    if (!m_active)
+        qWarning() << "Failed to begin transaction:" << m_db.lastError().text();
+}
+
+DatabaseTransaction::~DatabaseTransaction()
+{
+    if (m_active && !m_db.rollback())
+        qWarning() << "Failed to roll back transaction:" << m_db.lastError().text();
+}
+
+bool DatabaseTransaction::commit()
+{
+    if (!m_active)
+        return false;
+
+    m_active = false;
+    if (!m_db.commit()) {
+        qWarning() << "Failed to commit transaction:" << m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
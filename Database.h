@@ -3,6 +3,7 @@
 #include <QSqlQuery>
 #include <QDebug>
 #include <QCryptographicHash>
+#include <QStringList>
 
 
 #ifndef DATABASE_H
@@ -10,8 +11,33 @@
 
 class Database {
 public:
-    static bool connect();
+    static bool connect(int maxConnections = 16);
 
+    // Идемпотентные изменения схемы, которые сервер поддерживает сам (колонки, индексы)
+    static bool ensureSchema();
+
+    // Литерал массива PostgreSQL ("{1,2,3}") для параметров вида = ANY(CAST(? AS integer[]))
+    static QString toIntArray(const QList<int> &ids);
+    // То же для text[]: каждый элемент в кавычках, " и \ экранируются
+    static QString toTextArray(const QStringList &values);
+
+};
+
+// Транзакция на соединении из пула. Если commit() не был вызван,
+// деструктор откатывает изменения, так что ранний return ничего не оставляет.
+class DatabaseTransaction
+{
+public:
+    explicit DatabaseTransaction(const QSqlDatabase &db);
+    ~DatabaseTransaction();
+
+    bool isActive() const { return m_active; }
+    bool commit();
+
+private:
+    Q_DISABLE_COPY(DatabaseTransaction)
+    QSqlDatabase m_db;
+    bool m_active = false;
 };
 
 #endif // DATABASE_H
@@ -1,12 +1,68 @@
 #include "EntriesDatabase.h"
+#include "DataVersions.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
 
 bool EntriesDatabase::saveUserEntry(const QString &login, const EntryUser &entry)
 {
-    QSqlQuery query;
-    query.prepare(R"(
-        INSERT INTO entries (user_login, entry_title, entry_content, entry_mood_id, entry_folder_id, entry_date, entry_time)
-        VALUES (:login, :title, :content, :moodId, :folderId, :date, :time)
-        RETURNING id;
+    METRICS_QUERY_SCOPE("EntriesDatabase::saveUserEntry");
+    PooledConnection connection;
+    DatabaseTransaction transaction(connection.database());
+    if (!transaction.isActive()) {
+        return false;
+    }
+    if (!lockDailyMoodStats(connection, login))
+        return false;
+    const quint64 cacheStamp = MoodColumnsCache::instance().writeStamp();
+    // entry_time NOT NULL, а QPSQL передаёт невалидный QTime явным NULL,
+    // на который DEFAULT колонки не действует
+    const QTime time = entry.time.isValid() ? entry.time : QTime(0, 0);
+
+    // Запись, все её связи, счётчик папки и сводка дня обновляются одним оператором:
+    // число обращений к базе не зависит от количества тегов, активностей и эмоций,
+    // а при ошибке транзакция откатывается целиком.
+    QSqlQuery &query = connection.prepared(R"(
+        WITH new_entry AS (
+            INSERT INTO entries (user_login, entry_title, entry_content, entry_mood_id, entry_folder_id, entry_date, entry_time)
+            VALUES (:login, :title, :content, :moodId, :folderId, :date, :time)
+            RETURNING id
+        ),
+        tags AS (
+            INSERT INTO entry_tags (entry_id, tag_id)
+            SELECT new_entry.id, item FROM new_entry, unnest(CAST(:tagIds AS integer[])) AS item
+        ),
+        activities AS (
+            INSERT INTO entry_user_activities (entry_id, user_activity_id)
+            SELECT new_entry.id, item FROM new_entry, unnest(CAST(:activityIds AS integer[])) AS item
+        ),
+        emotions AS (
+            INSERT INTO entry_user_emotions (entry_id, user_emotion_id)
+            SELECT new_entry.id, item FROM new_entry, unnest(CAST(:emotionIds AS integer[])) AS item
+        ),
+        folder AS (
+            UPDATE folders
+            SET itemcount = itemcount + 1
+            WHERE id = :folderId
+        ),
+        day_stats AS (
+            INSERT INTO daily_mood_stats AS s (user_login, stat_date, entry_count, mood_sum, mood_min, mood_max,
+                                               last_mood, last_time, last_entry_id)
+            SELECT :login, CAST(:date AS date), 1, CAST(:moodId AS integer), CAST(:moodId AS integer),
+                   CAST(:moodId AS integer), CAST(:moodId AS integer),
+                   CAST(:time AS time), new_entry.id
+            FROM new_entry
+            ON CONFLICT (user_login, stat_date) DO UPDATE
+            SET entry_count = s.entry_count + 1,
+                mood_sum = s.mood_sum + EXCLUDED.mood_sum,
+                mood_min = LEAST(s.mood_min, EXCLUDED.mood_min),
+                mood_max = GREATEST(s.mood_max, EXCLUDED.mood_max),
+                last_mood = CASE WHEN (EXCLUDED.last_time, EXCLUDED.last_entry_id) > (s.last_time, s.last_entry_id)
+                                 THEN EXCLUDED.last_mood ELSE s.last_mood END,
+                last_entry_id = CASE WHEN (EXCLUDED.last_time, EXCLUDED.last_entry_id) > (s.last_time, s.last_entry_id)
+                                     THEN EXCLUDED.last_entry_id ELSE s.last_entry_id END,
+                last_time = GREATEST(s.last_time, EXCLUDED.last_time)
+        )
+        SELECT id FROM new_entry
     )");
 
     query.bindValue(":login", login);
@@ -15,7 +71,12 @@ bool EntriesDatabase::saveUserEntry(const QString &login, const EntryUser &entry
     query.bindValue(":moodId", entry.moodId);
     query.bindValue(":folderId", entry.folderId);
     query.bindValue(":date", entry.date);
-    query.bindValue(":time", entry.time);
+    query.bindValue(":time", time);
+    const QList<int> activityIds = relationIds(entry.activities, "entry_user_activities");
+    const QList<int> emotionIds = relationIds(entry.emotions, "entry_user_emotions");
+    query.bindValue(":tagIds", Database::toIntArray(relationIds(entry.tags, "entry_tags")));
+    query.bindValue(":activityIds", Database::toIntArray(activityIds));
+    query.bindValue(":emotionIds", Database::toIntArray(emotionIds));
 
     if (!query.exec()) {
         qWarning() << "Ошибка при вставке в entries:" << query.lastError().text();
@@ -31,292 +92,255 @@ bool EntriesDatabase::saveUserEntry(const QString &login, const EntryUser &entry
         return false;
     }
 
-    auto insertRelation = [&](const QString &tableName, const QString &columnName, const QVector<UserItem> &items) -> bool {
-        for (const UserItem &item : items) {
-            if (item.id <= 0) {
-                qWarning() << QString("Пропущен недопустимый ID (%1) для связи %2").arg(item.id).arg(tableName);
-                continue;
-            }
-
-            QSqlQuery linkQuery;
-            QString sql = QString("INSERT INTO %1 (entry_id, %2) VALUES (:entryId, :itemId);")
-                              .arg(tableName, columnName);
-            linkQuery.prepare(sql);
-            linkQuery.bindValue(":entryId", entryId);
-            linkQuery.bindValue(":itemId", item.id);
-
-            if (!linkQuery.exec()) {
-                qWarning() << QString("Ошибка при вставке в %1 (entry_id=%2, %3=%4): %5")
-                                  .arg(tableName)
-                                  .arg(entryId)
-                                  .arg(columnName)
-                                  .arg(item.id)
-                                  .arg(linkQuery.lastError().text());
-                return false;
-            }
-        }
-        return true;
-    };
-
-    if (!insertRelation("entry_tags", "tag_id", entry.tags)) return false;
-    if (!insertRelation("entry_user_activities", "user_activity_id", entry.activities)) return false;
-    if (!insertRelation("entry_user_emotions", "user_emotion_id", entry.emotions)) return false;
-
-    QSqlQuery updateFolderQuery;
-    updateFolderQuery.prepare(R"(
-        UPDATE folders
-        SET itemcount = itemcount + 1
-        WHERE id = :folderId;
-    )");
-    updateFolderQuery.bindValue(":folderId", entry.folderId);
-
-    if (!updateFolderQuery.exec()) {
-        qWarning() << "Ошибка при увеличении itemcount в folders:" << updateFolderQuery.lastError().text();
+    if (!transaction.commit())
         return false;
-    }
 
+    // itemcount папок меняется вместе с записями
+    DataVersions::bump(login, {DataVersions::Collection::Entries, DataVersions::Collection::Folders});
+    EntryPageCache::instance().invalidateMonth(login, entry.folderId, entry.date);
+    MoodColumnsCache::instance().entrySaved(login, cacheStamp, entryId, entry.date, time, entry.moodId,
+                                            activityIds, emotionIds);
     return true;
 }
 
 
 //--------- загрузка записей -------------------------
 
-QList<EntryUser> EntriesDatabase::getUserEntries(const QString &login, int folderId, int year, int month)
+EntryPage EntriesDatabase::getUserEntries(const QString &login, int folderId, int year, int month, const PageRequest &page, bool *ok)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::getUserEntries");
     QList<EntryUser> entries;
+    if (ok)
+        *ok = false;
+
+    const QDate monthStart(year, month, 1);
+    if (!monthStart.isValid()) {
+        qWarning() << "Invalid year/month:" << year << month;
+        return EntryPage();
+    }
 
-    QSqlQuery query;
-    query.prepare(R"(
+    // Полуоткрытый диапазон [1-е число; 1-е число следующего месяца) использует
+    // индекс entries_user_folder_date_idx, EXTRACT(...) по колонке — нет.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(QString(R"(
         SELECT id, entry_title, entry_content, entry_mood_id, entry_folder_id, entry_date, entry_time
         FROM entries
         WHERE user_login = :login
           AND entry_folder_id = :folderId
-          AND EXTRACT(YEAR FROM entry_date) = :year
-          AND EXTRACT(MONTH FROM entry_date) = :month
-        ORDER BY id ASC
-    )");
+          AND entry_date >= CAST(:monthStart AS date)
+          AND entry_date < CAST(:monthEnd AS date)
+          %1
+        %2
+    )").arg(keysetCondition(page), keysetOrder(page)));
     query.bindValue(":login", login);
     query.bindValue(":folderId", folderId);
-    query.bindValue(":year", year);
-    query.bindValue(":month", month);
+    query.bindValue(":monthStart", monthStart.toString(Qt::ISODate));
+    query.bindValue(":monthEnd", monthStart.addMonths(1).toString(Qt::ISODate));
+    bindPage(query, page);
 
     if (!query.exec()) {
         qWarning() << "Failed to get entries:" << query.lastError().text();
-        return entries;
+        return EntryPage();
     }
 
     while (query.next()) {
-        int entryId = query.value("id").toInt();
-        QString title = query.value("entry_title").toString();
-        QString content = query.value("entry_content").toString();
-        int moodId = query.value("entry_mood_id").toInt();
-        int folderId = query.value("entry_folder_id").toInt();
-        QDate date = query.value("entry_date").toDate();
-        QTime time = query.value("entry_time").toTime();
-
-        QVector<UserItem> tags = getTagsForEntry(entryId);
-        QVector<UserItem> activities = getActivitiesForEntry(entryId);
-        QVector<UserItem> emotions = getEmotionsForEntry(entryId);
-
-        EntryUser entry(entryId, login, title, content, moodId, folderId, date, time, tags, activities, emotions);
-        entries.append(entry);
+        entries.append(readEntry(query, login));
     }
 
-    return entries;
+    EntryPage result = makePage(std::move(entries), page);
+    loadRelations(connection, result.entries);
+    if (ok)
+        *ok = true;
+    return result;
 }
 
-QList<EntryUser> EntriesDatabase::getUserEntriesByKeywords(const QString &login, const QStringList &keywords)
+EntryPage EntriesDatabase::getUserEntriesByKeywords(const QString &login, const QStringList &keywords, KeywordSearchMode mode, const PageRequest &page)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::getUserEntriesByKeywords");
+    if (mode == KeywordSearchMode::Substring)
+        return getUserEntriesBySubstrings(login, keywords, page);
+
     QList<EntryUser> entries;
 
     if (keywords.isEmpty()) {
         qWarning() << "No keywords provided.";
-        return entries;
+        return EntryPage();
+    }
+
+    // entry_search поддерживается самим PostgreSQL (см. Database::ensureSchema)
+    // и покрыт GIN-индексом, поэтому HTML не разбирается на каждом поиске.
+    // Без пагинации результаты идут по релевантности, постранично — в порядке курсора.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(QString(R"(
+        SELECT id, entry_title, entry_content, entry_mood_id, entry_folder_id, entry_date, entry_time,
+               ts_rank(entry_search, q) AS rank
+        FROM entries, websearch_to_tsquery('russian', :query) AS q
+        WHERE user_login = :login
+          AND entry_search @@ q
+          %1
+        %2
+    )").arg(keysetCondition(page),
+            page.isPaged() ? keysetOrder(page) : QString("ORDER BY rank DESC, id ASC")));
+    query.bindValue(":login", login);
+    query.bindValue(":query", keywords.join(" or "));
+    bindPage(query, page);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to get entries by keywords:" << query.lastError().text();
+        return EntryPage();
     }
 
-    QStringList conditions;
-    for (int i = 0; i < keywords.size(); ++i) {
-        QString key = QString("%%%1%%").arg(keywords[i]);
-        conditions << QString(R"(
-            (entry_title ILIKE :kw%1 OR
-             regexp_replace(
-                 regexp_replace(entry_content, '<[^>]*>', '', 'g'),
-                 E'&[#a-zA-Z0-9]+;', '', 'g'
-             ) ILIKE :kw%1)
-        )").arg(i);
+    while (query.next()) {
+        entries.append(readEntry(query, login));
+    }
+
+    EntryPage result = makePage(std::move(entries), page);
+    loadRelations(connection, result.entries);
+    return result;
+}
+
+EntryPage EntriesDatabase::getUserEntriesBySubstrings(const QString &login, const QStringList &keywords, const PageRequest &page)
+{
+    METRICS_QUERY_SCOPE("EntriesDatabase::getUserEntriesBySubstrings");
+    QList<EntryUser> entries;
 
+    if (keywords.isEmpty()) {
+        qWarning() << "No keywords provided.";
+        return EntryPage();
     }
 
-    QString keywordCondition = conditions.join(" OR ");
+    // Все ключевые слова передаются одним параметром-массивом, поэтому текст
+    // запроса не зависит от их количества и подготавливается один раз.
+    QStringList patterns;
+    patterns.reserve(keywords.size());
+    for (const QString &keyword : keywords) {
+        patterns << "%" + keyword + "%";
+    }
 
     QString queryStr = QString(R"(
         SELECT id, entry_title, entry_content, entry_mood_id, entry_folder_id, entry_date, entry_time
         FROM entries
         WHERE user_login = :login
-          AND (%1)
-        ORDER BY id ASC
-    )").arg(keywordCondition);
-
-    QSqlQuery query;
-    query.prepare(queryStr);
+          AND (entry_title ILIKE ANY(CAST(:patterns AS text[])) OR
+               regexp_replace(
+                   regexp_replace(entry_content, '<[^>]*>', '', 'g'),
+                   E'&[#a-zA-Z0-9]+;', '', 'g'
+               ) ILIKE ANY(CAST(:patterns AS text[])))
+          %1
+        %2
+    )").arg(keysetCondition(page), keysetOrder(page));
+
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(queryStr);
     query.bindValue(":login", login);
-    for (int i = 0; i < keywords.size(); ++i) {
-        query.bindValue(QString(":kw%1").arg(i), "%" + keywords[i] + "%");
-    }
+    query.bindValue(":patterns", Database::toTextArray(patterns));
+    bindPage(query, page);
 
     if (!query.exec()) {
         qWarning() << "Failed to get entries by keywords:" << query.lastError().text();
-        return entries;
+        return EntryPage();
     }
 
     while (query.next()) {
-        int entryId = query.value("id").toInt();
-        QString title = query.value("entry_title").toString();
-        QString content = query.value("entry_content").toString();
-        int moodId = query.value("entry_mood_id").toInt();
-        int folderId = query.value("entry_folder_id").toInt();
-        QDate date = query.value("entry_date").toDate();
-        QTime time = query.value("entry_time").toTime();
-
-        QVector<UserItem> tags = getTagsForEntry(entryId);
-        QVector<UserItem> activities = getActivitiesForEntry(entryId);
-        QVector<UserItem> emotions = getEmotionsForEntry(entryId);
-
-        EntryUser entry(entryId, login, title, content, moodId, folderId, date, time, tags, activities, emotions);
-        entries.append(entry);
+        entries.append(readEntry(query, login));
     }
 
-    return entries;
+    EntryPage result = makePage(std::move(entries), page);
+    loadRelations(connection, result.entries);
+    return result;
 }
 
-QList<EntryUser> EntriesDatabase::getUserEntriesByTags(const QString &login, const QList<int> &tagIds, const QList<int> &emotionIds, const QList<int> &activityIds)
+EntryPage EntriesDatabase::getUserEntriesByTags(const QString &login, const QList<int> &tagIds, const QList<int> &emotionIds, const QList<int> &activityIds, const PageRequest &page)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::getUserEntriesByTags");
     QList<EntryUser> entries;
-    QSet<int> addedEntryIds;
 
     if (tagIds.isEmpty() && emotionIds.isEmpty() && activityIds.isEmpty()) {
         qWarning() << "Все списки пустые — нечего искать.";
-        return entries;
+        return EntryPage();
     }
 
-    auto makePlaceholders = [](int count) -> QString {
-        return QString("?, ").repeated(count).chopped(2);
-    };
-
-    auto fetchEntries = [&](const QString& tableName, const QString& columnName, const QList<int>& ids) {
-        if (ids.isEmpty()) return;
-
-        QString placeholders = makePlaceholders(ids.size());
-
-        QString queryStr = QString(R"(
-            SELECT DISTINCT e.id, e.entry_title, e.entry_content, e.entry_mood_id,
-                            e.entry_folder_id, e.entry_date, e.entry_time
-            FROM entries e
-            JOIN %1 rel ON e.id = rel.entry_id
-            JOIN users u ON e.user_login = u.user_login
-            WHERE u.user_login = ?
-              AND rel.%2 IN (%3)
-        )").arg(tableName, columnName, placeholders);
-
-        QSqlQuery query;
-        if (!query.prepare(queryStr)) {
-            qWarning() << "Ошибка подготовки запроса (" << tableName << "):" << query.lastError().text();
-            return;
-        }
-
-        query.addBindValue(login);
-        for (int id : ids)
-            query.addBindValue(id);
-
-        if (!query.exec()) {
-            qWarning() << "Ошибка выполнения запроса (" << tableName << "):" << query.lastError().text();
-            return;
-        }
-
-        while (query.next()) {
-            int entryId = query.value("id").toInt();
-            if (addedEntryIds.contains(entryId))
-                continue;
-
-            QString title = query.value("entry_title").toString();
-            QString content = query.value("entry_content").toString();
-            int moodId = query.value("entry_mood_id").toInt();
-            int folderId = query.value("entry_folder_id").toInt();
-            QDate date = query.value("entry_date").toDate();
-            QTime time = query.value("entry_time").toTime();
-
-            QVector<UserItem> tags = getTagsForEntry(entryId);
-            QVector<UserItem> activities = getActivitiesForEntry(entryId);
-            QVector<UserItem> emotions = getEmotionsForEntry(entryId);
+    // Один запрос вместо трёх: запись подходит, если у неё есть хотя бы один
+    // из переданных тегов, эмоций или активностей. Пустой массив ничего не находит.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(QString(R"(
+        SELECT e.id, e.entry_title, e.entry_content, e.entry_mood_id,
+               e.entry_folder_id, e.entry_date, e.entry_time
+        FROM entries e
+        WHERE e.user_login = :login
+          AND (EXISTS (SELECT 1 FROM entry_tags rel
+                       WHERE rel.entry_id = e.id AND rel.tag_id = ANY(CAST(:tagIds AS integer[])))
+            OR EXISTS (SELECT 1 FROM entry_user_emotions rel
+                       WHERE rel.entry_id = e.id AND rel.user_emotion_id = ANY(CAST(:emotionIds AS integer[])))
+            OR EXISTS (SELECT 1 FROM entry_user_activities rel
+                       WHERE rel.entry_id = e.id AND rel.user_activity_id = ANY(CAST(:activityIds AS integer[]))))
+          %1
+        %2
+    )").arg(keysetCondition(page, "e."), keysetOrder(page, "e.")));
+    query.bindValue(":login", login);
+    query.bindValue(":tagIds", Database::toIntArray(tagIds));
+    query.bindValue(":emotionIds", Database::toIntArray(emotionIds));
+    query.bindValue(":activityIds", Database::toIntArray(activityIds));
+    bindPage(query, page);
 
-            EntryUser entry(entryId, login, title, content, moodId, folderId, date, time, tags, activities, emotions);
-            entries.append(entry);
-            addedEntryIds.insert(entryId);
-        }
-    };
+    if (!query.exec()) {
+        qWarning() << "Failed to get entries by tags:" << query.lastError().text();
+        return EntryPage();
+    }
 
-    fetchEntries("entry_tags", "tag_id", tagIds);
-    fetchEntries("entry_user_emotions", "user_emotion_id", emotionIds);
-    fetchEntries("entry_user_activities", "user_activity_id", activityIds);
+    while (query.next()) {
+        entries.append(readEntry(query, login));
+    }
 
-    return entries;
+    EntryPage result = makePage(std::move(entries), page);
+    loadRelations(connection, result.entries);
+    return result;
 }
 
 
-QList<EntryUser> EntriesDatabase::getUserEntriesByDate(const QString &login, const QString &dateStr)
+EntryPage EntriesDatabase::getUserEntriesByDate(const QString &login, const QString &dateStr, const PageRequest &page)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::getUserEntriesByDate");
     QList<EntryUser> entries;
 
     if (login.isEmpty() || dateStr.isEmpty()) {
         qWarning() << "Login or date is empty.";
-        return entries;
+        return EntryPage();
     }
 
-    QString queryStr = R"(
+    QString queryStr = QString(R"(
         SELECT e.id, e.entry_title, e.entry_content, e.entry_mood_id, e.entry_folder_id, e.entry_date, e.entry_time
         FROM entries e
-        JOIN users u ON e.user_login = u.user_login
-        WHERE u.user_login = ?
-          AND e.entry_date = ?
-        ORDER BY e.id ASC
-    )";
+        WHERE e.user_login = :login
+          AND e.entry_date = CAST(:date AS date)
+          %1
+        %2
+    )").arg(keysetCondition(page, "e."), keysetOrder(page, "e."));
 
-    QSqlQuery query;
-    if (!query.prepare(queryStr)) {
-        qWarning() << "Query prepare failed:" << query.lastError().text();
-        return entries;
-    }
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(queryStr);
 
-    query.addBindValue(login);
-    query.addBindValue(dateStr);
+    query.bindValue(":login", login);
+    query.bindValue(":date", dateStr);
+    bindPage(query, page);
 
     if (!query.exec()) {
         qWarning() << "Failed to get entries by date:" << query.lastError().text();
-        return entries;
+        return EntryPage();
     }
 
     while (query.next()) {
-        int entryId = query.value("id").toInt();
-        QString title = query.value("entry_title").toString();
-        QString content = query.value("entry_content").toString();
-        int moodId = query.value("entry_mood_id").toInt();
-        int folderId = query.value("entry_folder_id").toInt();
-        QDate date = query.value("entry_date").toDate();
-        QTime time = query.value("entry_time").toTime();
-
-        QVector<UserItem> tags = getTagsForEntry(entryId);
-        QVector<UserItem> activities = getActivitiesForEntry(entryId);
-        QVector<UserItem> emotions = getEmotionsForEntry(entryId);
-
-        EntryUser entry(entryId, login, title, content, moodId, folderId, date, time, tags, activities, emotions);
-        entries.append(entry);
+        entries.append(readEntry(query, login));
     }
 
-    return entries;
+    EntryPage result = makePage(std::move(entries), page);
+    loadRelations(connection, result.entries);
+    return result;
 }
 
 QList<int> EntriesDatabase::getLastMoodIdsByDate(const QString &login, const QString &dateStr)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::getLastMoodIdsByDate");
     QList<int> moodIds;
 
     if (login.isEmpty() || dateStr.isEmpty()) {
@@ -330,43 +354,95 @@ QList<int> EntriesDatabase::getLastMoodIdsByDate(const QString &login, const QSt
         return moodIds;
     }
 
-    QString queryStr = R"(
-        SELECT entry_mood_id
-        FROM entries
-        WHERE user_login = ? AND entry_date = ?
-        ORDER BY entry_time DESC
-        LIMIT 3
-    )";
-
-    QSqlQuery query;
-    if (!query.prepare(queryStr)) {
-        qWarning() << "Query prepare failed:" << query.lastError().text();
-        return moodIds;
+    moodIds = getLastMoodIdsByRange(login, date, date).value(date);
+    if (moodIds.isEmpty()) {
+        moodIds.append(0);
     }
 
-    query.addBindValue(login);
-    query.addBindValue(date.toString("yyyy-MM-dd"));
+    return moodIds;
+}
 
-    if (!query.exec()) {
-        qWarning() << "Failed to execute query:" << query.lastError().text();
-        return moodIds;
+QMap<QDate, QList<int>> EntriesDatabase::getLastMoodIdsByRange(const QString &login, const QDate &from, const QDate &to,
+                                                               int perDay, bool *ok)
+{
+    METRICS_QUERY_SCOPE("EntriesDatabase::getLastMoodIdsByRange");
+    QMap<QDate, QList<int>> moodsByDay;
+    if (ok)
+        *ok = false;
+
+    if (login.isEmpty() || !from.isValid() || !to.isValid() || from > to || perDay <= 0) {
+        qWarning() << "Invalid mood range request:" << login << from << to << perDay;
+        return moodsByDay;
     }
 
-    while (query.next()) {
-        int moodId = query.value(0).toInt();
-        moodIds.append(moodId);
+    // Последние perDay настроений каждого дня одним запросом: нумерация внутри
+    // дня от поздних записей к ранним, дальше берутся первые номера.
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
+        SELECT entry_date, entry_mood_id
+        FROM (
+            SELECT entry_date, entry_mood_id,
+                   ROW_NUMBER() OVER (PARTITION BY entry_date ORDER BY entry_time DESC, id DESC) AS day_rank
+            FROM entries
+            WHERE user_login = :login
+              AND entry_date >= CAST(:from AS date)
+              AND entry_date <= CAST(:to AS date)
+        ) ranked
+        WHERE day_rank <= :perDay
+        ORDER BY entry_date, day_rank
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":from", from.toString(Qt::ISODate));
+    query.bindValue(":to", to.toString(Qt::ISODate));
+    query.bindValue(":perDay", perDay);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to load moods by range:" << query.lastError().text();
+        return moodsByDay;
     }
 
-    if (moodIds.isEmpty()) {
-        moodIds.append(0);
+    while (query.next()) {
+        moodsByDay[query.value(0).toDate()].append(query.value(1).toInt());
     }
 
-    return moodIds;
+    if (ok)
+        *ok = true;
+    return moodsByDay;
 }
 
 bool EntriesDatabase::deleteUserEntry(const QString &login, int entryId)
 {
-    QSqlDatabase::database().transaction();
+    METRICS_QUERY_SCOPE("EntriesDatabase::deleteUserEntry");
+    PooledConnection connection;
+    QSqlDatabase db = connection.database();
+    DatabaseTransaction transaction(db);
+    if (!transaction.isActive()) {
+        return false;
+    }
+    if (!lockDailyMoodStats(connection, login))
+        return false;
+    const quint64 cacheStamp = MoodColumnsCache::instance().writeStamp();
+
+    // Связи удаляются только у записи этого пользователя; её папка и дата
+    // нужны, чтобы сбросить кэш именно того месяца.
+    QSqlQuery &ownerQuery = connection.prepared(R"(
+        SELECT entry_folder_id, entry_date FROM entries
+        WHERE id = :entryId AND user_login = :login
+        FOR UPDATE
+    )");
+    ownerQuery.bindValue(":entryId", entryId);
+    ownerQuery.bindValue(":login", login);
+    if (!ownerQuery.exec()) {
+        qWarning() << "Ошибка при поиске записи:" << ownerQuery.lastError().text();
+        return false;
+    }
+    if (!ownerQuery.next()) {
+        qWarning() << "Запись id" << entryId << "не найдена для пользователя" << login;
+        return false;
+    }
+    const int folderId = ownerQuery.value(0).toInt();
+    const QDate date = ownerQuery.value(1).toDate();
+
     QStringList relatedTables = {
         "entry_tags",
         "entry_user_activities",
@@ -374,17 +450,14 @@ bool EntriesDatabase::deleteUserEntry(const QString &login, int entryId)
     };
 
     for (const QString &table : relatedTables) {
-        QSqlQuery deleteRel;
-        deleteRel.prepare(QString("DELETE FROM %1 WHERE entry_id = :entryId;").arg(table));
+        QSqlQuery &deleteRel = connection.prepared(QString("DELETE FROM %1 WHERE entry_id = :entryId;").arg(table));
         deleteRel.bindValue(":entryId", entryId);
         if (!deleteRel.exec()) {
             qWarning() << "Ошибка при удалении из " << table << ":" << deleteRel.lastError().text();
-            QSqlDatabase::database().rollback();
             return false;
         }
     }
-    QSqlQuery deleteEntryQuery;
-    deleteEntryQuery.prepare(R"(
+    QSqlQuery &deleteEntryQuery = connection.prepared(R"(
         DELETE FROM entries WHERE id = :entryId AND user_login = :login;
     )");
     deleteEntryQuery.bindValue(":entryId", entryId);
@@ -392,45 +465,59 @@ bool EntriesDatabase::deleteUserEntry(const QString &login, int entryId)
 
     if (!deleteEntryQuery.exec()) {
         qWarning() << "Ошибка при удалении записи:" << deleteEntryQuery.lastError().text();
-        QSqlDatabase::database().rollback();
         return false;
     }
 
-    QSqlDatabase::database().commit();
+    if (!refreshDailyMoodStats(connection, login, {date}))
+        return false;
+
+    if (!transaction.commit())
+        return false;
+
+    DataVersions::bump(login, {DataVersions::Collection::Entries, DataVersions::Collection::Folders});
+    EntryPageCache::instance().invalidateMonth(login, folderId, date);
+    MoodColumnsCache::instance().entryRemoved(login, cacheStamp, entryId);
     return true;
 }
 
 
 bool EntriesDatabase::updateUserEntry(const QString &login, const EntryUser &entry)
 {
+    METRICS_QUERY_SCOPE("EntriesDatabase::updateUserEntry");
     if (entry.id <= 0) {
         qWarning() << "Invalid entry id for update:" << entry.id;
         return false;
     }
 
-    QSqlDatabase db = QSqlDatabase::database();
-    QSqlQuery query(db);
-
-    int oldFolderId = -1;
-    query.prepare("SELECT entry_folder_id FROM entries WHERE id = :id AND user_login = :login");
-    query.bindValue(":id", entry.id);
-    query.bindValue(":login", login);
-
-    if (!query.exec() || !query.next()) {
-        qWarning() << "Не удалось получить старую папку для записи id:" << entry.id << query.lastError().text();
+    PooledConnection connection;
+    QSqlDatabase db = connection.database();
+    DatabaseTransaction transaction(db);
+    if (!transaction.isActive()) {
         return false;
     }
-    oldFolderId = query.value(0).toInt();
+    if (!lockDailyMoodStats(connection, login))
+        return false;
+    const quint64 cacheStamp = MoodColumnsCache::instance().writeStamp();
+    const QTime time = entry.time.isValid() ? entry.time : QTime(0, 0);
 
-    query.prepare(R"(
-        UPDATE entries
+    // 1) Обновляем запись и сразу получаем её прежние папку и дату из той же строки.
+    //    Если folder не передан (<= 0), папка записи не меняется.
+    QSqlQuery &query = connection.prepared(R"(
+        UPDATE entries e
         SET entry_title = :title,
             entry_content = :content,
             entry_mood_id = :moodId,
             entry_date = :date,
             entry_time = :time,
-            entry_folder_id = :folderId
-        WHERE id = :id AND user_login = :login
+            entry_folder_id = CASE WHEN :folderId > 0 THEN :folderId ELSE old.entry_folder_id END
+        FROM (
+            SELECT id, entry_folder_id, entry_date
+            FROM entries
+            WHERE id = :id AND user_login = :login
+            FOR UPDATE
+        ) AS old
+        WHERE e.id = old.id
+        RETURNING old.entry_folder_id, old.entry_date, e.entry_folder_id, e.entry_date
     )");
 
     query.bindValue(":title", entry.title);
@@ -438,7 +525,7 @@ bool EntriesDatabase::updateUserEntry(const QString &login, const EntryUser &ent
     query.bindValue(":moodId", entry.moodId);
     query.bindValue(":folderId", entry.folderId);
     query.bindValue(":date", entry.date);
-    query.bindValue(":time", entry.time);
+    query.bindValue(":time", time);
     query.bindValue(":id", entry.id);
     query.bindValue(":login", login);
 
@@ -446,157 +533,302 @@ bool EntriesDatabase::updateUserEntry(const QString &login, const EntryUser &ent
         qWarning() << "Ошибка при обновлении записи в entries:" << query.lastError().text();
         return false;
     }
+    if (!query.next()) {
+        qWarning() << "Запись id" << entry.id << "не найдена для пользователя" << login;
+        return false;
+    }
+    const int oldFolderId = query.value(0).toInt();
+    const QDate oldDate = query.value(1).toDate();
+    const int newFolderId = query.value(2).toInt();
+    const QDate newDate = query.value(3).toDate();
+
+    // 2) Связи меняются по разности множеств: удаляются только убранные id,
+    //    вставляются только новые. Удаление и вставка в одном операторе видят
+    //    один снимок данных, поэтому их строки не пересекаются.
+    QSqlQuery &relationsQuery = connection.prepared(R"(
+        WITH tags_removed AS (
+            DELETE FROM entry_tags
+            WHERE entry_id = :entryId AND NOT (tag_id = ANY(CAST(:tagIds AS integer[])))
+        ),
+        tags_added AS (
+            INSERT INTO entry_tags (entry_id, tag_id)
+            SELECT CAST(:entryId AS integer), item FROM unnest(CAST(:tagIds AS integer[])) AS item
+            WHERE NOT EXISTS (SELECT 1 FROM entry_tags WHERE entry_id = :entryId AND tag_id = item)
+        ),
+        activities_removed AS (
+            DELETE FROM entry_user_activities
+            WHERE entry_id = :entryId AND NOT (user_activity_id = ANY(CAST(:activityIds AS integer[])))
+        ),
+        activities_added AS (
+            INSERT INTO entry_user_activities (entry_id, user_activity_id)
+            SELECT CAST(:entryId AS integer), item FROM unnest(CAST(:activityIds AS integer[])) AS item
+            WHERE NOT EXISTS (SELECT 1 FROM entry_user_activities WHERE entry_id = :entryId AND user_activity_id = item)
+        ),
+        emotions_removed AS (
+            DELETE FROM entry_user_emotions
+            WHERE entry_id = :entryId AND NOT (user_emotion_id = ANY(CAST(:emotionIds AS integer[])))
+        )
+        INSERT INTO entry_user_emotions (entry_id, user_emotion_id)
+        SELECT CAST(:entryId AS integer), item FROM unnest(CAST(:emotionIds AS integer[])) AS item
+        WHERE NOT EXISTS (SELECT 1 FROM entry_user_emotions WHERE entry_id = :entryId AND user_emotion_id = item)
+    )");
+    relationsQuery.bindValue(":entryId", entry.id);
+    relationsQuery.bindValue(":tagIds", Database::toIntArray(relationIds(entry.tags, "entry_tags")));
+    const QList<int> activityIds = relationIds(entry.activities, "entry_user_activities");
+    const QList<int> emotionIds = relationIds(entry.emotions, "entry_user_emotions");
+    relationsQuery.bindValue(":activityIds", Database::toIntArray(activityIds));
+    relationsQuery.bindValue(":emotionIds", Database::toIntArray(emotionIds));
+
+    if (!relationsQuery.exec()) {
+        qWarning() << "Ошибка при обновлении связей записи:" << relationsQuery.lastError().text();
+        return false;
+    }
 
-    // 3) Удаляем старые связи с тегами, активностями и эмоциями
-    auto deleteRelations = [&](const QString &tableName) -> bool {
-        QSqlQuery delQuery(db);
-        delQuery.prepare(QString("DELETE FROM %1 WHERE entry_id = :entryId").arg(tableName));
-        delQuery.bindValue(":entryId", entry.id);
-        if (!delQuery.exec()) {
-            qWarning() << "Ошибка при удалении связей в" << tableName << ":" << delQuery.lastError().text();
-            return false;
-        }
-        return true;
-    };
-
-    if (!deleteRelations("entry_tags")) return false;
-    if (!deleteRelations("entry_user_activities")) return false;
-    if (!deleteRelations("entry_user_emotions")) return false;
-
-    // 4) Вставляем новые связи
-    auto insertRelations = [&](const QString &tableName, const QString &columnName, const QVector<UserItem> &items) -> bool {
-        QSqlQuery insQuery(db);
-        QString sql = QString("INSERT INTO %1 (entry_id, %2) VALUES (:entryId, :itemId)").arg(tableName, columnName);
-        insQuery.prepare(sql);
-        for (const UserItem &item : items) {
-            if (item.id <= 0) {
-                qWarning() << "Пропущен недопустимый ID" << item.id << "для таблицы" << tableName;
-                continue;
-            }
-            insQuery.bindValue(":entryId", entry.id);
-            insQuery.bindValue(":itemId", item.id);
-            if (!insQuery.exec()) {
-                qWarning() << "Ошибка при вставке связи в" << tableName << ":" << insQuery.lastError().text();
-                return false;
-            }
-        }
-        return true;
-    };
-
-    if (!insertRelations("entry_tags", "tag_id", entry.tags)) return false;
-    if (!insertRelations("entry_user_activities", "user_activity_id", entry.activities)) return false;
-    if (!insertRelations("entry_user_emotions", "user_emotion_id", entry.emotions)) return false;
+    // 3) Счётчики папок трогаем, только если запись переехала.
     if (oldFolderId != entry.folderId && oldFolderId > 0 && entry.folderId > 0) {
-        QSqlQuery folderQuery(db);
-        folderQuery.prepare(R"(
+        QSqlQuery &folderQuery = connection.prepared(R"(
             UPDATE folders
-            SET itemcount = GREATEST(itemcount - 1, 0)
-            WHERE id = :oldFolderId
+            SET itemcount = CASE WHEN id = :newFolderId THEN itemcount + 1
+                                 ELSE GREATEST(itemcount - 1, 0) END
+            WHERE id IN (:oldFolderId, :newFolderId)
         )");
         folderQuery.bindValue(":oldFolderId", oldFolderId);
-        if (!folderQuery.exec()) {
-            qWarning() << "Ошибка при уменьшении itemcount в старой папке:" << folderQuery.lastError().text();
-            return false;
-        }
-
-        // Увеличиваем счетчик в новой папке
-        folderQuery.prepare(R"(
-            UPDATE folders
-            SET itemcount = itemcount + 1
-            WHERE id = :newFolderId
-        )");
         folderQuery.bindValue(":newFolderId", entry.folderId);
         if (!folderQuery.exec()) {
-            qWarning() << "Ошибка при увеличении itemcount в новой папке:" << folderQuery.lastError().text();
+            qWarning() << "Ошибка при обновлении itemcount папок:" << folderQuery.lastError().text();
             return false;
         }
     }
 
+    // 4) Сводка пересчитывается по прежнему и новому дню записи.
+    if (!refreshDailyMoodStats(connection, login, {oldDate, newDate}))
+        return false;
+
+    if (!transaction.commit())
+        return false;
+
+    DataVersions::bump(login, {DataVersions::Collection::Entries, DataVersions::Collection::Folders});
+    EntryPageCache &cache = EntryPageCache::instance();
+    cache.invalidateMonth(login, oldFolderId, oldDate);
+    if (newFolderId != oldFolderId || newDate.year() != oldDate.year() || newDate.month() != oldDate.month())
+        cache.invalidateMonth(login, newFolderId, newDate);
+    MoodColumnsCache::instance().entryUpdated(login, cacheStamp, entry.id, newDate, time, entry.moodId,
+                                              activityIds, emotionIds);
     return true;
 }
 
 //--------- все остальное ----------
 
-QVector<UserItem> EntriesDatabase::getTagsForEntry(int entryId)
+bool EntriesDatabase::lockDailyMoodStats(PooledConnection &connection, const QString &login)
 {
-    QVector<UserItem> tags;
-
-    QSqlQuery query;
-    query.prepare(R"(
-        SELECT t.id, t.name, 0 AS icon_id
-        FROM entry_tags et
-        JOIN user_tags t ON et.tag_id = t.id
-        WHERE et.entry_id = :entryId
+    // Снимается сама при COMMIT/ROLLBACK. Совпадение hashtext у разных
+    // пользователей лишь упорядочит их записи.
+    QSqlQuery &query = connection.prepared(R"(
+        SELECT pg_advisory_xact_lock(hashtext('daily_mood_stats'), hashtext(:login))
     )");
-    query.bindValue(":entryId", entryId);
+    query.bindValue(":login", login);
+    if (!query.exec()) {
+        qWarning() << "Ошибка при блокировке сводки настроения:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
 
-    if (query.exec()) {
-        while (query.next()) {
-            tags.append(UserItem{
-                query.value("id").toInt(),
-                query.value("icon_id").toInt(),
-                query.value("name").toString()
-            });
-        }
-    } else {
-        qWarning() << "Failed to get tags for entry" << entryId << ":" << query.lastError().text();
+bool EntriesDatabase::refreshDailyMoodStats(PooledConnection &connection, const QString &login, const QList<QDate> &days)
+{
+    METRICS_QUERY_SCOPE("EntriesDatabase::refreshDailyMoodStats");
+
+    QStringList dayList;
+    for (const QDate &day : days) {
+        if (day.isValid())
+            dayList.append(day.toString(Qt::ISODate));
+    }
+
+    // Дни пересчитываются целиком по entries: при изменении или удалении записи
+    // минимум, максимум и последнее настроение дня инкрементально не восстановить.
+    // Дни, в которых записей не осталось, удаляются.
+    QSqlQuery &query = connection.prepared(R"(
+        WITH days AS (
+            SELECT entry_date AS stat_date,
+                   COUNT(*) AS entry_count,
+                   SUM(entry_mood_id) AS mood_sum,
+                   MIN(entry_mood_id) AS mood_min,
+                   MAX(entry_mood_id) AS mood_max,
+                   (ARRAY_AGG(entry_mood_id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1] AS last_mood,
+                   MAX(COALESCE(entry_time, TIME '00:00')) AS last_time,
+                   (ARRAY_AGG(id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1] AS last_entry_id
+            FROM entries
+            WHERE user_login = :login
+              AND entry_mood_id IS NOT NULL
+              AND (CAST(:allDays AS boolean) OR entry_date = ANY(CAST(:days AS date[])))
+            GROUP BY entry_date
+        ),
+        removed AS (
+            DELETE FROM daily_mood_stats
+            WHERE user_login = :login
+              AND (CAST(:allDays AS boolean) OR stat_date = ANY(CAST(:days AS date[])))
+              AND stat_date NOT IN (SELECT stat_date FROM days)
+        )
+        INSERT INTO daily_mood_stats (user_login, stat_date, entry_count, mood_sum, mood_min, mood_max,
+                                      last_mood, last_time, last_entry_id)
+        SELECT :login, stat_date, entry_count, mood_sum, mood_min, mood_max, last_mood, last_time, last_entry_id
+        FROM days
+        ON CONFLICT (user_login, stat_date) DO UPDATE
+        SET entry_count = EXCLUDED.entry_count,
+            mood_sum = EXCLUDED.mood_sum,
+            mood_min = EXCLUDED.mood_min,
+            mood_max = EXCLUDED.mood_max,
+            last_mood = EXCLUDED.last_mood,
+            last_time = EXCLUDED.last_time,
+            last_entry_id = EXCLUDED.last_entry_id
+    )");
+    query.bindValue(":login", login);
+    query.bindValue(":allDays", days.isEmpty());
+    query.bindValue(":days", Database::toTextArray(dayList));
+
+    if (!query.exec()) {
+        qWarning() << "Ошибка при пересчёте сводки настроения по дням:" << query.lastError().text();
+        return false;
     }
+    return true;
+}
+
+// Keyset-пагинация: ключ (entry_date, entry_time, id) уникален и растёт,
+// поэтому следующая страница — это строки строго после курсора, а не OFFSET.
+QString EntriesDatabase::keysetCondition(const PageRequest &page, const QString &prefix)
+{
+    if (!page.after.isValid())
+        return QString();
 
-    return tags;
+    return QString("AND (%1entry_date, %1entry_time, %1id) > "
+                   "(CAST(:afterDate AS date), CAST(:afterTime AS time), :afterId)").arg(prefix);
 }
 
-QVector<UserItem> EntriesDatabase::getActivitiesForEntry(int entryId)
+QString EntriesDatabase::keysetOrder(const PageRequest &page, const QString &prefix)
 {
-    QVector<UserItem> activities;
-
-    QSqlQuery query;
-    query.prepare(R"(
-        SELECT a.id, a.icon_id, a.icon_label
-        FROM entry_user_activities eua
-        JOIN user_activities a ON eua.user_activity_id = a.id
-        WHERE eua.entry_id = :entryId
-    )");
-    query.bindValue(":entryId", entryId);
+    QString sql = QString("ORDER BY %1entry_date, %1entry_time, %1id").arg(prefix);
+    if (page.isPaged())
+        sql += " LIMIT :pageLimit";
+    return sql;
+}
 
-    if (query.exec()) {
-        while (query.next()) {
-            activities.append(UserItem{
-                query.value("id").toInt(),
-                query.value("icon_id").toInt(),
-                query.value("icon_label").toString()
-            });
+void EntriesDatabase::bindPage(QSqlQuery &query, const PageRequest &page)
+{
+    if (page.after.isValid()) {
+        query.bindValue(":afterDate", page.after.date.toString(Qt::ISODate));
+        query.bindValue(":afterTime", page.after.time.toString("HH:mm:ss.zzz"));
+        query.bindValue(":afterId", page.after.id);
+    }
+    // одна лишняя строка показывает, есть ли следующая страница
+    if (page.isPaged())
+        query.bindValue(":pageLimit", page.limit + 1);
+}
+
+EntryPage EntriesDatabase::makePage(QList<EntryUser> entries, const PageRequest &page)
+{
+    EntryPage result;
+    if (page.isPaged() && entries.size() > page.limit) {
+        entries.resize(page.limit);
+        const EntryUser &last = entries.constLast();
+        result.nextCursor = EntryCursor{ last.date, last.time, last.id }.encode();
+    }
+    result.entries = std::move(entries);
+    return result;
+}
+
+QList<int> EntriesDatabase::relationIds(const QVector<UserItem> &items, const QString &tableName)
+{
+    QList<int> ids;
+    ids.reserve(items.size());
+    for (const UserItem &item : items) {
+        if (item.id <= 0) {
+            qWarning() << QString("Пропущен недопустимый ID (%1) для связи %2").arg(item.id).arg(tableName);
+            continue;
         }
-    } else {
-        qWarning() << "Failed to get activities for entry" << entryId << ":" << query.lastError().text();
+        if (!ids.contains(item.id))
+            ids.append(item.id);
     }
+    return ids;
+}
 
-    return activities;
+EntryUser EntriesDatabase::readEntry(const QSqlQuery &query, const QString &login)
+{
+    EntryUser entry;
+    entry.id = query.value("id").toInt();
+    entry.userLogin = login;
+    entry.title = query.value("entry_title").toString();
+    entry.content = query.value("entry_content").toString();
+    entry.moodId = query.value("entry_mood_id").toInt();
+    entry.folderId = query.value("entry_folder_id").toInt();
+    entry.date = query.value("entry_date").toDate();
+    entry.time = query.value("entry_time").toTime();
+    return entry;
 }
 
-QVector<UserItem> EntriesDatabase::getEmotionsForEntry(int entryId)
+// Теги, активности и эмоции подгружаются сразу для всей выборки:
+// три запроса на любой размер результата вместо трёх на каждую запись.
+void EntriesDatabase::loadRelations(PooledConnection &connection, QList<EntryUser> &entries)
 {
-    QVector<UserItem> emotions;
-
-    QSqlQuery query;
-    query.prepare(R"(
-        SELECT e.id, e.icon_id, e.icon_label
-        FROM entry_user_emotions eue
-        JOIN user_emotions e ON eue.user_emotion_id = e.id
-        WHERE eue.entry_id = :entryId
-    )");
-    query.bindValue(":entryId", entryId);
+    METRICS_QUERY_SCOPE("EntriesDatabase::loadRelations");
+    if (entries.isEmpty())
+        return;
+
+    QHash<int, qsizetype> indexById;
+    QList<int> ids;
+    indexById.reserve(entries.size());
+    ids.reserve(entries.size());
+    for (qsizetype i = 0; i < entries.size(); ++i) {
+        indexById.insert(entries[i].id, i);
+        ids.append(entries[i].id);
+    }
+    const QString idArray = Database::toIntArray(ids);
+
+    struct Relation {
+        const char *name;
+        const char *sql;
+        QVector<UserItem> EntryUser::*items;
+    };
+
+    static const Relation relations[] = {
+        { "tags", R"(
+            SELECT et.entry_id, t.id, 0 AS icon_id, t.name
+            FROM entry_tags et
+            JOIN user_tags t ON et.tag_id = t.id
+            WHERE et.entry_id = ANY(CAST(:ids AS integer[]))
+        )", &EntryUser::tags },
+        { "activities", R"(
+            SELECT eua.entry_id, a.id, a.icon_id, a.icon_label
+            FROM entry_user_activities eua
+            JOIN user_activities a ON eua.user_activity_id = a.id
+            WHERE eua.entry_id = ANY(CAST(:ids AS integer[]))
+        )", &EntryUser::activities },
+        { "emotions", R"(
+            SELECT eue.entry_id, e.id, e.icon_id, e.icon_label
+            FROM entry_user_emotions eue
+            JOIN user_emotions e ON eue.user_emotion_id = e.id
+            WHERE eue.entry_id = ANY(CAST(:ids AS integer[]))
+        )", &EntryUser::emotions },
+    };
+
+    for (const Relation &relation : relations) {
+        QSqlQuery &query = connection.prepared(relation.sql);
+        query.bindValue(":ids", idArray);
+
+        if (!query.exec()) {
+            qWarning() << "Failed to get" << relation.name << "for entries:" << query.lastError().text();
+            continue;
+        }
 
-    if (query.exec()) {
         while (query.next()) {
-            emotions.append(UserItem{
-                query.value("id").toInt(),
-                query.value("icon_id").toInt(),
-                query.value("icon_label").toString()
+            const auto it = indexById.constFind(query.value(0).toInt());
+            if (it == indexById.constEnd())
+                continue;
+
+            (entries[*it].*relation.items).append(UserItem{
+                query.value(1).toInt(),
+                query.value(2).toInt(),
+                query.value(3).toString()
             });
         }
-    } else {
-        qWarning() << "Failed to get emotions for entry" << entryId << ":" << query.lastError().text();
     }
-
-    return emotions;
 }
@@ -7,26 +7,63 @@
 #include <QVariant>
 #include <QDebug>
 #include <QString>
+#include <QHash>
+#include <QMap>
+#include <QDate>
 #include "EntryUser.h"
+#include "EntryPage.h"
+#include "ConnectionPool.h"
+#include "Metrics.h"
+#include "Database.h"
 
 class EntriesDatabase
 {
 public:
+    enum class KeywordSearchMode {
+        FullText,   // websearch_to_tsquery по entry_search, с ранжированием
+        Substring   // прежний ILIKE '%kw%' по тексту без HTML
+    };
 
     static bool saveUserEntry(const QString &login, const EntryUser &entry);
     static bool deleteUserEntry(const QString &login, int entryId);
     static bool updateUserEntry(const QString &login, const EntryUser &entry);
-    static QList<EntryUser> getUserEntries(const QString &login, int folderId, int year, int month);
-    static QList<EntryUser> getUserEntriesByKeywords(const QString &login, const QStringList &keywords);
-    static QList<EntryUser> getUserEntriesByTags(const QString &login, const QList<int> &tagIds, const QList<int> &emotionIds, const QList<int> &activityIds);
-    static QList<EntryUser> getUserEntriesByDate(const QString &login, const QString &dateStr);
+    // ok == false — ошибка запроса, а не пустой месяц
+    static EntryPage getUserEntries(const QString &login, int folderId, int year, int month,
+                                    const PageRequest &page = PageRequest(), bool *ok = nullptr);
+    static EntryPage getUserEntriesByKeywords(const QString &login, const QStringList &keywords,
+                                              KeywordSearchMode mode = KeywordSearchMode::FullText,
+                                              const PageRequest &page = PageRequest());
+    static EntryPage getUserEntriesByTags(const QString &login, const QList<int> &tagIds, const QList<int> &emotionIds, const QList<int> &activityIds,
+                                          const PageRequest &page = PageRequest());
+    static EntryPage getUserEntriesByDate(const QString &login, const QString &dateStr,
+                                          const PageRequest &page = PageRequest());
+    // Транзакционная блокировка сводки пользователя. Берётся в начале каждой
+    // транзакции, меняющей daily_mood_stats: пересчёт читает снимок entries на
+    // начало оператора и затёр бы день, который параллельно дополнила ещё не
+    // закоммиченная вставка.
+    static bool lockDailyMoodStats(PooledConnection &connection, const QString &login);
+    // Пересчитывает daily_mood_stats пользователя по entries за указанные дни
+    // (пустой список — за все дни). Вызывается внутри транзакции, изменившей
+    // записи, после lockDailyMoodStats().
+    static bool refreshDailyMoodStats(PooledConnection &connection, const QString &login,
+                                      const QList<QDate> &days = QList<QDate>());
     static QList<int> getLastMoodIdsByDate(const QString &login, const QString &dateStr);
+    // Последние perDay настроений (от поздних к ранним) для каждого дня [from; to],
+    // в котором есть записи; дни без записей в ответ не попадают.
+    static QMap<QDate, QList<int>> getLastMoodIdsByRange(const QString &login, const QDate &from, const QDate &to,
+                                                         int perDay = 3, bool *ok = nullptr);
 
 
 private:
-    static QVector<UserItem> getTagsForEntry(int entryId);
-    static QVector<UserItem> getActivitiesForEntry(int entryId);
-    static QVector<UserItem> getEmotionsForEntry(int entryId);
+    static EntryPage getUserEntriesBySubstrings(const QString &login, const QStringList &keywords, const PageRequest &page);
+    static QList<int> relationIds(const QVector<UserItem> &items, const QString &tableName);
+    static EntryUser readEntry(const QSqlQuery &query, const QString &login);
+    static void loadRelations(PooledConnection &connection, QList<EntryUser> &entries);
+
+    static QString keysetCondition(const PageRequest &page, const QString &prefix = QString());
+    static QString keysetOrder(const PageRequest &page, const QString &prefix = QString());
+    static void bindPage(QSqlQuery &query, const PageRequest &page);
+    static EntryPage makePage(QList<EntryUser> entries, const PageRequest &page);
 };
 
 #endif // ENTRIESDATABASE_H
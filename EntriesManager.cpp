@@ -1,5 +1,13 @@
 #include "EntriesManager.h"
 #include "EntriesDatabase.h"
+#include "EntryJsonWriter.h"
+#include "DataVersions.h"
+#include "EntryPageCache.h"
+#include "Trace.h"
+
+// Подробности запросов к записям по умолчанию не пишутся; включаются через
+// QT_LOGGING_RULES="psqlserver.entries.debug=true".
+Q_LOGGING_CATEGORY(lcEntries, "psqlserver.entries", QtInfoMsg)
 
 QDate EntriesManager::parseDate(const QString &dateStr) {
     QDate d = QDate::fromString(dateStr, Qt::ISODate);
@@ -11,6 +19,22 @@ QTime EntriesManager::parseTime(const QString &timeStr) {
     return t.isValid() ? t : QTime::currentTime();
 }
 
+bool EntriesManager::parsePageRequest(int limit, const QString &after, PageRequest &page)
+{
+    page.limit = qBound(0, limit, PageRequest::MaxLimit);
+    if (after.isEmpty())
+        return true;
+
+    page.after = EntryCursor::decode(after);
+    return page.after.isValid();
+}
+
+QJsonDocument EntriesManager::parseBody(const QByteArray &body, QJsonParseError *error)
+{
+    TRACE_SPAN("parse");
+    return QJsonDocument::fromJson(body, error);
+}
+
 QVector<UserItem> EntriesManager::parseUserItemsArray(const QJsonValue &jsonValue) {
     QVector<UserItem> items;
     if (!jsonValue.isArray())
@@ -29,10 +53,10 @@ QVector<UserItem> EntriesManager::parseUserItemsArray(const QJsonValue &jsonValu
 
 QHttpServerResponse EntriesManager::handleSaveEntry(const QHttpServerRequest &request)
 {
-    qDebug() << "handleSaveEntry вызван.";
+    qCDebug(lcEntries) << "handleSaveEntry вызван.";
 
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body(), &parseError);
+    QJsonDocument jsonDoc = parseBody(request.body(), &parseError);
 
     if (parseError.error != QJsonParseError::NoError || !jsonDoc.isObject()) {
         qWarning() << "Некорректный JSON в запросе на сохранение записи:" << parseError.errorString();
@@ -66,10 +90,12 @@ QHttpServerResponse EntriesManager::handleSaveEntry(const QHttpServerRequest &re
     QVector<UserItem> activities = parseUserItemsArray(json.value("activities"));
     QVector<UserItem> emotions = parseUserItemsArray(json.value("emotions"));
 
-    EntryUser entry = EntryUser::fromJson(json);
+    // Дата и время берутся уже разобранными: без "time" в запросе запись
+    // получает текущее время, а не пустое значение, которое колонка не примет.
+    EntryUser entry(0, login, title, content, moodId, folderId, date, time, tags, activities, emotions);
 
     if (EntriesDatabase::saveUserEntry(login, entry)) {
-        qDebug() << "Запись успешно сохранена для пользователя:" << login;
+        qCDebug(lcEntries) << "Запись успешно сохранена для пользователя:" << login;
         return QHttpServerResponse("Entry saved successfully", QHttpServerResponse::StatusCode::Ok);
     } else {
         qWarning() << "Ошибка при сохранении записи для пользователя:" << login;
@@ -79,7 +105,7 @@ QHttpServerResponse EntriesManager::handleSaveEntry(const QHttpServerRequest &re
 
 QHttpServerResponse EntriesManager::handleGetUserEntries(const QHttpServerRequest &request)
 {
-    qDebug() << "Received request at /getuserentries";
+    qCDebug(lcEntries) << "Received request at /getuserentries";
     if (request.method() != QHttpServerRequest::Method::Get) {
         return QHttpServerResponse("Invalid method", QHttpServerResponse::StatusCode::MethodNotAllowed);
     }
@@ -90,7 +116,7 @@ QHttpServerResponse EntriesManager::handleGetUserEntries(const QHttpServerReques
     const int year = query.queryItemValue("year").toInt();
     const int month = query.queryItemValue("month").toInt();
 
-    qDebug() << "Extracted params - login:" << login
+    qCDebug(lcEntries) << "Extracted params - login:" << login
              << "| folderId:" << folderId
              << "| year:" << year
              << "| month:" << month;
@@ -99,69 +125,37 @@ QHttpServerResponse EntriesManager::handleGetUserEntries(const QHttpServerReques
         return QHttpServerResponse("Missing or invalid parameters", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QList<EntryUser> entries = EntriesDatabase::getUserEntries(login, folderId, year, month);
-    qDebug() << "Entries fetched from DB:" << entries.size();
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Entries);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
 
-    if (entries.isEmpty()) {
-        QJsonObject response;
-        response["entries"] = QJsonArray();
-        return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    PageRequest page;
+    if (!parsePageRequest(query.queryItemValue("limit").toInt(), query.queryItemValue("after"), page)) {
+        return QHttpServerResponse("Invalid cursor", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QJsonArray entriesArray;
-
-    for (const EntryUser &entry : entries) {
-        QJsonObject entryObj;
-        entryObj["id"] = entry.id;
-        entryObj["title"] = entry.title;
-        entryObj["content"] = entry.content;
-        entryObj["moodId"] = entry.moodId;
-        entryObj["folderId"] = entry.folderId;
-        entryObj["date"] = entry.date.toString(Qt::ISODate);
-        entryObj["time"] = entry.time.toString("HH:mm");
+    EntryPageCache &cache = EntryPageCache::instance();
+    const EntryPageCache::Key cacheKey{login, folderId, year, month, page.limit, query.queryItemValue("after")};
+    QByteArray json = cache.find(cacheKey);
+    if (json.isNull()) {
+        const quint64 writeToken = cache.writeToken(login);
+        bool ok = false;
+        const EntryPage result = EntriesDatabase::getUserEntries(login, folderId, year, month, page, &ok);
+        qCDebug(lcEntries) << "Entries fetched from DB:" << result.entries.size();
 
-        QJsonArray tagsArray;
-        for (const auto &tag : entry.tags) {
-            QJsonObject tagObj;
-            tagObj["id"] = tag.id;
-            tagObj["iconId"] = tag.iconId;
-            tagObj["label"] = tag.label;
-            tagsArray.append(tagObj);
-        }
-        entryObj["tags"] = tagsArray;
-
-        QJsonArray activitiesArray;
-        for (const auto &act : entry.activities) {
-            QJsonObject actObj;
-            actObj["id"] = act.id;
-            actObj["iconId"] = act.iconId;
-            actObj["label"] = act.label;
-            activitiesArray.append(actObj);
-        }
-        entryObj["activities"] = activitiesArray;
-
-        QJsonArray emotionsArray;
-        for (const auto &emo : entry.emotions) {
-            QJsonObject emoObj;
-            emoObj["id"] = emo.id;
-            emoObj["iconId"] = emo.iconId;
-            emoObj["label"] = emo.label;
-            emotionsArray.append(emoObj);
-        }
-        entryObj["emotions"] = emotionsArray;
-
-        entriesArray.append(entryObj);
+        json = EntryJsonWriter::writeEntries(result.entries, result.nextCursor);
+        if (ok)
+            cache.insert(cacheKey, json, writeToken);
     }
 
-    QJsonObject response;
-    response["entries"] = entriesArray;
-
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse response("application/json", json);
+    DataVersions::setETag(response, etag);
+    return response;
 }
 
 QHttpServerResponse EntriesManager::handleSearchEntriesByKeywords(const QHttpServerRequest &request)
 {
-    qDebug() << "[/searchentriesbywords] Request received.";
+    qCDebug(lcEntries) << "[/searchentriesbywords] Request received.";
 
     if (request.method() != QHttpServerRequest::Method::Post) {
         qWarning() << "Invalid method:" << request.method();
@@ -170,9 +164,9 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByKeywords(const QHttpSer
 
     QJsonParseError parseError;
     const QByteArray body = request.body();
-    qDebug() << "Raw body:" << QString::fromUtf8(body);
+    qCDebug(lcEntries) << "Raw body:" << body;
 
-    const QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+    const QJsonDocument doc = parseBody(body, &parseError);
     if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
         qWarning() << "JSON parse error:" << parseError.errorString();
         return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
@@ -195,65 +189,29 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByKeywords(const QHttpSer
         }
     }
 
-    qDebug() << "Parsed login:" << login;
-    qDebug() << "Parsed keywords:" << keywords;
-
-    QList<EntryUser> entries = EntriesDatabase::getUserEntriesByKeywords(login, keywords);
-    qDebug() << "Found entries count:" << entries.size();
-
-    QJsonArray entriesArray;
-    for (const EntryUser &entry : entries) {
-        QJsonObject entryObj;
-        entryObj["id"] = entry.id;
-        entryObj["title"] = entry.title;
-        entryObj["content"] = entry.content;
-        entryObj["moodId"] = entry.moodId;
-        entryObj["folderId"] = entry.folderId;
-        entryObj["date"] = entry.date.toString(Qt::ISODate);
-        entryObj["time"] = entry.time.toString("HH:mm");
-
-        QJsonArray tagsArray;
-        for (const auto &tag : entry.tags) {
-            QJsonObject tagObj;
-            tagObj["id"] = tag.id;
-            tagObj["iconId"] = tag.iconId;
-            tagObj["label"] = tag.label;
-            tagsArray.append(tagObj);
-        }
-        entryObj["tags"] = tagsArray;
-
-        QJsonArray activitiesArray;
-        for (const auto &act : entry.activities) {
-            QJsonObject actObj;
-            actObj["id"] = act.id;
-            actObj["iconId"] = act.iconId;
-            actObj["label"] = act.label;
-            activitiesArray.append(actObj);
-        }
-        entryObj["activities"] = activitiesArray;
-
-        QJsonArray emotionsArray;
-        for (const auto &emo : entry.emotions) {
-            QJsonObject emoObj;
-            emoObj["id"] = emo.id;
-            emoObj["iconId"] = emo.iconId;
-            emoObj["label"] = emo.label;
-            emotionsArray.append(emoObj);
-        }
-        entryObj["emotions"] = emotionsArray;
+    qCDebug(lcEntries) << "Parsed login:" << login;
+    qCDebug(lcEntries) << "Parsed keywords:" << keywords;
+
+    // "mode": "substring" — прежний поиск по подстроке, по умолчанию полнотекстовый
+    const EntriesDatabase::KeywordSearchMode mode = obj.value("mode").toString() == "substring"
+        ? EntriesDatabase::KeywordSearchMode::Substring
+        : EntriesDatabase::KeywordSearchMode::FullText;
 
-        entriesArray.append(entryObj);
+    PageRequest page;
+    if (!parsePageRequest(obj.value("limit").toInt(), obj.value("after").toString(), page)) {
+        return QHttpServerResponse("Invalid cursor", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QJsonObject response;
-    response["entries"] = entriesArray;
+    const EntryPage result = EntriesDatabase::getUserEntriesByKeywords(login, keywords, mode, page);
+    const QList<EntryUser> &entries = result.entries;
+    qCDebug(lcEntries) << "Found entries count:" << entries.size();
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    return QHttpServerResponse("application/json", EntryJsonWriter::writeEntries(entries, result.nextCursor));
 }
 
 QHttpServerResponse EntriesManager::handleSearchEntriesByTags(const QHttpServerRequest &request)
 {
-    qDebug() << "[/searchentriesbytags] Request received.";
+    qCDebug(lcEntries) << "[/searchentriesbytags] Request received.";
 
     if (request.method() != QHttpServerRequest::Method::Post) {
         qWarning() << "Invalid method:" << request.method();
@@ -262,9 +220,9 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByTags(const QHttpServerR
 
     QJsonParseError parseError;
     const QByteArray body = request.body();
-    qDebug() << "Raw body:" << QString::fromUtf8(body);
+    qCDebug(lcEntries) << "Raw body:" << body;
 
-    const QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+    const QJsonDocument doc = parseBody(body, &parseError);
     if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
         qWarning() << "JSON parse error:" << parseError.errorString();
         return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
@@ -300,67 +258,26 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByTags(const QHttpServerR
         }
     }
 
-    qDebug() << "Parsed login:" << login;
-    qDebug() << "Parsed tag IDs:" << tagIds;
-    qDebug() << "Parsed emotion IDs:" << emotionIds;
-    qDebug() << "Parsed activity IDs:" << axtivityIds;
-
-    QList<EntryUser> entries = EntriesDatabase::getUserEntriesByTags(login, tagIds, emotionIds, axtivityIds);
-    qDebug() << "Found entries count:" << entries.size();
-
-    QJsonArray entriesArray;
-    for (const EntryUser &entry : entries) {
-        QJsonObject entryObj;
-        entryObj["id"] = entry.id;
-        entryObj["title"] = entry.title;
-        entryObj["content"] = entry.content;
-        entryObj["moodId"] = entry.moodId;
-        entryObj["folderId"] = entry.folderId;
-        entryObj["date"] = entry.date.toString(Qt::ISODate);
-        entryObj["time"] = entry.time.toString("HH:mm");
-
-        QJsonArray tagsArray;
-        for (const auto &tag : entry.tags) {
-            QJsonObject tagObj;
-            tagObj["id"] = tag.id;
-            tagObj["iconId"] = tag.iconId;
-            tagObj["label"] = tag.label;
-            tagsArray.append(tagObj);
-        }
-        entryObj["tags"] = tagsArray;
-
-        QJsonArray activitiesArray;
-        for (const auto &act : entry.activities) {
-            QJsonObject actObj;
-            actObj["id"] = act.id;
-            actObj["iconId"] = act.iconId;
-            actObj["label"] = act.label;
-            activitiesArray.append(actObj);
-        }
-        entryObj["activities"] = activitiesArray;
-
-        QJsonArray emotionsArray;
-        for (const auto &emo : entry.emotions) {
-            QJsonObject emoObj;
-            emoObj["id"] = emo.id;
-            emoObj["iconId"] = emo.iconId;
-            emoObj["label"] = emo.label;
-            emotionsArray.append(emoObj);
-        }
-        entryObj["emotions"] = emotionsArray;
+    qCDebug(lcEntries) << "Parsed login:" << login;
+    qCDebug(lcEntries) << "Parsed tag IDs:" << tagIds;
+    qCDebug(lcEntries) << "Parsed emotion IDs:" << emotionIds;
+    qCDebug(lcEntries) << "Parsed activity IDs:" << axtivityIds;
 
-        entriesArray.append(entryObj);
+    PageRequest page;
+    if (!parsePageRequest(obj.value("limit").toInt(), obj.value("after").toString(), page)) {
+        return QHttpServerResponse("Invalid cursor", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QJsonObject response;
-    response["entries"] = entriesArray;
+    const EntryPage result = EntriesDatabase::getUserEntriesByTags(login, tagIds, emotionIds, axtivityIds, page);
+    const QList<EntryUser> &entries = result.entries;
+    qCDebug(lcEntries) << "Found entries count:" << entries.size();
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    return QHttpServerResponse("application/json", EntryJsonWriter::writeEntries(entries, result.nextCursor));
 }
 
 QHttpServerResponse EntriesManager::handleSearchEntriesByDate(const QHttpServerRequest &request)
 {
-    qDebug() << "[/searchentriesbydate] Request received.";
+    qCDebug(lcEntries) << "[/searchentriesbydate] Request received.";
 
     if (request.method() != QHttpServerRequest::Method::Post) {
         qWarning() << "Invalid method:" << request.method();
@@ -369,9 +286,9 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByDate(const QHttpServerR
 
     QJsonParseError parseError;
     const QByteArray body = request.body();
-    qDebug() << "Raw body:" << QString::fromUtf8(body);
+    qCDebug(lcEntries) << "Raw body:" << body;
 
-    const QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+    const QJsonDocument doc = parseBody(body, &parseError);
     if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
         qWarning() << "JSON parse error:" << parseError.errorString();
         return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
@@ -386,60 +303,19 @@ QHttpServerResponse EntriesManager::handleSearchEntriesByDate(const QHttpServerR
         return QHttpServerResponse("Missing login or date", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    qDebug() << "Parsed login:" << login;
-    qDebug() << "Parsed date:" << dateStr;
-
-    QList<EntryUser> entries = EntriesDatabase::getUserEntriesByDate(login, dateStr);
-    qDebug() << "Found entries count:" << entries.size();
-
-    QJsonArray entriesArray;
-    for (const EntryUser &entry : entries) {
-        QJsonObject entryObj;
-        entryObj["id"] = entry.id;
-        entryObj["title"] = entry.title;
-        entryObj["content"] = entry.content;
-        entryObj["moodId"] = entry.moodId;
-        entryObj["folderId"] = entry.folderId;
-        entryObj["date"] = entry.date.toString(Qt::ISODate);
-        entryObj["time"] = entry.time.toString("HH:mm");
-
-        QJsonArray tagsArray;
-        for (const auto &tag : entry.tags) {
-            QJsonObject tagObj;
-            tagObj["id"] = tag.id;
-            tagObj["iconId"] = tag.iconId;
-            tagObj["label"] = tag.label;
-            tagsArray.append(tagObj);
-        }
-        entryObj["tags"] = tagsArray;
-
-        QJsonArray activitiesArray;
-        for (const auto &act : entry.activities) {
-            QJsonObject actObj;
-            actObj["id"] = act.id;
-            actObj["iconId"] = act.iconId;
-            actObj["label"] = act.label;
-            activitiesArray.append(actObj);
-        }
-        entryObj["activities"] = activitiesArray;
-
-        QJsonArray emotionsArray;
-        for (const auto &emo : entry.emotions) {
-            QJsonObject emoObj;
-            emoObj["id"] = emo.id;
-            emoObj["iconId"] = emo.iconId;
-            emoObj["label"] = emo.label;
-            emotionsArray.append(emoObj);
-        }
-        entryObj["emotions"] = emotionsArray;
+    qCDebug(lcEntries) << "Parsed login:" << login;
+    qCDebug(lcEntries) << "Parsed date:" << dateStr;
 
-        entriesArray.append(entryObj);
+    PageRequest page;
+    if (!parsePageRequest(obj.value("limit").toInt(), obj.value("after").toString(), page)) {
+        return QHttpServerResponse("Invalid cursor", QHttpServerResponse::StatusCode::BadRequest);
     }
 
-    QJsonObject response;
-    response["entries"] = entriesArray;
+    const EntryPage result = EntriesDatabase::getUserEntriesByDate(login, dateStr, page);
+    const QList<EntryUser> &entries = result.entries;
+    qCDebug(lcEntries) << "Found entries count:" << entries.size();
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    return QHttpServerResponse("application/json", EntryJsonWriter::writeEntries(entries, result.nextCursor));
 }
 
 QHttpServerResponse EntriesManager::handleSearchEntriesMoodIdies(const QHttpServerRequest &request)
@@ -453,7 +329,7 @@ QHttpServerResponse EntriesManager::handleSearchEntriesMoodIdies(const QHttpServ
     QJsonParseError parseError;
     const QByteArray body = request.body();
 
-    const QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+    const QJsonDocument doc = parseBody(body, &parseError);
     if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
         qWarning() << "JSON parse error:" << parseError.errorString();
         return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
@@ -482,12 +358,70 @@ QHttpServerResponse EntriesManager::handleSearchEntriesMoodIdies(const QHttpServ
     return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
 }
 
+QHttpServerResponse EntriesManager::handleGetMoodIdiesByRange(const QHttpServerRequest &request)
+{
+    if (request.method() != QHttpServerRequest::Method::Post) {
+        qWarning() << "Invalid method:" << request.method();
+        return QHttpServerResponse("Invalid method", QHttpServerResponse::StatusCode::MethodNotAllowed);
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = parseBody(request.body(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "JSON parse error:" << parseError.errorString();
+        return QHttpServerResponse("Invalid JSON", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    const QJsonObject obj = doc.object();
+    const QString login = obj.value("login").toString();
+    const QDate from = QDate::fromString(obj.value("from").toString(), "yyyy-MM-dd");
+    const QDate to = QDate::fromString(obj.value("to").toString(), "yyyy-MM-dd");
+    const int perDay = obj.value("limit").toInt(3);
+
+    if (login.isEmpty() || !from.isValid() || !to.isValid() || from > to) {
+        qWarning() << "Missing login or invalid range. login:" << login << ", from:" << from << ", to:" << to;
+        return QHttpServerResponse("Missing login or invalid range", QHttpServerResponse::StatusCode::BadRequest);
+    }
+    if (from.daysTo(to) >= MaxMoodRangeDays || perDay < 1 || perDay > MaxMoodsPerDay) {
+        return QHttpServerResponse("Range or limit is too large", QHttpServerResponse::StatusCode::BadRequest);
+    }
+
+    bool ok = false;
+    const QMap<QDate, QList<int>> moodsByDay = EntriesDatabase::getLastMoodIdsByRange(login, from, to, perDay, &ok);
+    if (!ok) {
+        return QHttpServerResponse("Failed to load moods", QHttpServerResponse::StatusCode::InternalServerError);
+    }
+
+    // Каждый день диапазона присутствует в ответе; пустой день — [0], как в /getmoodidies
+    QJsonArray daysArray;
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        QJsonArray moodIdsArray;
+        const auto day = moodsByDay.constFind(date);
+        if (day == moodsByDay.constEnd()) {
+            moodIdsArray.append(0);
+        } else {
+            for (int moodId : *day)
+                moodIdsArray.append(moodId);
+        }
+
+        QJsonObject dayObj;
+        dayObj["date"] = date.toString("yyyy-MM-dd");
+        dayObj["moodIds"] = moodIdsArray;
+        daysArray.append(dayObj);
+    }
+
+    QJsonObject response;
+    response["days"] = daysArray;
+
+    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+}
+
 QHttpServerResponse EntriesManager::handleDeleteEntry(const QHttpServerRequest &request)
 {
-    qDebug() << "handleDeleteEntry вызван.";
+    qCDebug(lcEntries) << "handleDeleteEntry вызван.";
 
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body(), &parseError);
+    QJsonDocument jsonDoc = parseBody(request.body(), &parseError);
 
     if (parseError.error != QJsonParseError::NoError || !jsonDoc.isObject()) {
         qWarning() << "Некорректный JSON в запросе на удаление записи:" << parseError.errorString();
@@ -499,8 +433,8 @@ QHttpServerResponse EntriesManager::handleDeleteEntry(const QHttpServerRequest &
     const int entryId = json.value("id").toInt(-1);
     const QString login = json.value("login").toString().trimmed();
 
-    qDebug() << "айди записи" << entryId;
-    qDebug() << "логин записи" << login;
+    qCDebug(lcEntries) << "айди записи" << entryId;
+    qCDebug(lcEntries) << "логин записи" << login;
 
     if (entryId < 0 || login.isEmpty()) {
         qWarning() << "Отсутствует login или некорректный id в запросе.";
@@ -508,7 +442,7 @@ QHttpServerResponse EntriesManager::handleDeleteEntry(const QHttpServerRequest &
     }
 
     if (EntriesDatabase::deleteUserEntry(login, entryId)) {
-        qDebug() << "Запись с id" << entryId << "успешно удалена для пользователя:" << login;
+        qCDebug(lcEntries) << "Запись с id" << entryId << "успешно удалена для пользователя:" << login;
         return QHttpServerResponse("Entry deleted successfully", QHttpServerResponse::StatusCode::Ok);
     } else {
         qWarning() << "Ошибка при удалении записи с id" << entryId << "для пользователя:" << login;
@@ -518,10 +452,10 @@ QHttpServerResponse EntriesManager::handleDeleteEntry(const QHttpServerRequest &
 
 QHttpServerResponse EntriesManager::handleUpdateEntry(const QHttpServerRequest &request)
 {
-    qDebug() << "handleUpdateEntry вызван.";
+    qCDebug(lcEntries) << "handleUpdateEntry вызван.";
 
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(request.body(), &parseError);
+    QJsonDocument jsonDoc = parseBody(request.body(), &parseError);
 
     if (parseError.error != QJsonParseError::NoError || !jsonDoc.isObject()) {
         qWarning() << "Некорректный JSON в запросе на обновление записи:" << parseError.errorString();
@@ -566,7 +500,7 @@ QHttpServerResponse EntriesManager::handleUpdateEntry(const QHttpServerRequest &
 
     // Предположим, что updateUserEntry умеет обновлять запись по id
     if (EntriesDatabase::updateUserEntry(login, entry)) {
-        qDebug() << "Запись успешно обновлена для пользователя:" << login << "id:" << entryId;
+        qCDebug(lcEntries) << "Запись успешно обновлена для пользователя:" << login << "id:" << entryId;
         return QHttpServerResponse("Entry updated successfully", QHttpServerResponse::StatusCode::Ok);
     } else {
         qWarning() << "Ошибка при обновлении записи для пользователя:" << login << "id:" << entryId;
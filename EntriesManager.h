@@ -12,7 +12,9 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <QLoggingCategory>
 #include "EntryUser.h"
+#include "EntryPage.h"
 
 class EntriesManager
 {
@@ -27,12 +29,19 @@ public:
     QHttpServerResponse handleDeleteEntry(const QHttpServerRequest &request);
     QHttpServerResponse handleUpdateEntry(const QHttpServerRequest &request);
     QHttpServerResponse handleSearchEntriesMoodIdies(const QHttpServerRequest &request);
+    // Календарь за диапазон одним запросом: {"login", "from", "to", "limit"?} -> {"days": [{"date", "moodIds"}]}
+    QHttpServerResponse handleGetMoodIdiesByRange(const QHttpServerRequest &request);
+
+    static QVector<UserItem> parseUserItemsArray(const QJsonValue &jsonValue);
 
 private:
+    static constexpr int MaxMoodRangeDays = 366;
+    static constexpr int MaxMoodsPerDay = 10;
 
-    static QVector<UserItem> parseUserItemsArray(const QJsonValue &jsonValue);
     static QDate parseDate(const QString &dateStr);
     static QTime parseTime(const QString &timeStr);
+    static bool parsePageRequest(int limit, const QString &after, PageRequest &page);
+    static QJsonDocument parseBody(const QByteArray &body, QJsonParseError *error);
 };
 
 
@@ -0,0 +1,209 @@
+#include "EntryJsonWriter.h"
+
+#include <charconv>
+#include "Trace.h"
+
+QByteArray EntryJsonWriter::writeEntries(const QList<EntryUser> &entries, const QString &nextCursor)
+{
+    TRACE_SPAN("serialize");
+
+    // Текст записей в UTF-8 почти всегда не длиннее 2 байт на символ;
+    // запас на ключи и связи — чтобы буфер не перевыделялся по ходу.
+    qsizetype estimate = 32 + nextCursor.size();
+    for (const EntryUser &entry : entries) {
+        estimate += 256 + 2 * (entry.title.size() + entry.content.size())
+                    + 48 * (entry.tags.size() + entry.activities.size() + entry.emotions.size());
+    }
+
+    QByteArray out;
+    out.reserve(estimate);
+
+    out.append("{\"entries\":[");
+    for (qsizetype i = 0; i < entries.size(); ++i) {
+        if (i > 0)
+            out.append(',');
+        appendEntry(out, entries[i]);
+    }
+    out.append(']');
+
+    if (!nextCursor.isEmpty()) {
+        out.append(",\"nextCursor\":");
+        appendString(out, nextCursor);
+    }
+    out.append('}');
+    return out;
+}
+
+void EntryJsonWriter::appendEntry(QByteArray &out, const EntryUser &entry)
+{
+    out.append("{\"id\":");
+    appendInt(out, entry.id);
+    out.append(",\"title\":");
+    appendString(out, entry.title);
+    out.append(",\"content\":");
+    appendString(out, entry.content);
+    out.append(",\"moodId\":");
+    appendInt(out, entry.moodId);
+    out.append(",\"folderId\":");
+    appendInt(out, entry.folderId);
+    out.append(",\"date\":");
+    appendDate(out, entry.date);
+    out.append(",\"time\":");
+    appendTime(out, entry.time);
+    out.append(",\"tags\":");
+    appendItems(out, entry.tags);
+    out.append(",\"activities\":");
+    appendItems(out, entry.activities);
+    out.append(",\"emotions\":");
+    appendItems(out, entry.emotions);
+    out.append('}');
+}
+
+void EntryJsonWriter::appendItems(QByteArray &out, const QVector<UserItem> &items)
+{
+    out.append('[');
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        const UserItem &item = items[i];
+        out.append(i > 0 ? ",{\"id\":" : "{\"id\":");
+        appendInt(out, item.id);
+        out.append(",\"iconId\":");
+        appendInt(out, item.iconId);
+        out.append(",\"label\":");
+        appendString(out, item.label);
+        out.append('}');
+    }
+    out.append(']');
+}
+
+void EntryJsonWriter::appendInt(QByteArray &out, qint64 value)
+{
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+}
+
+void EntryJsonWriter::appendDate(QByteArray &out, const QDate &date)
+{
+    if (!date.isValid() || date.year() < 0 || date.year() > 9999) {
+        out.append("\"\"");
+        return;
+    }
+
+    const int year = date.year();
+    const char buffer[12] = {
+        '"',
+        char('0' + year / 1000), char('0' + year / 100 % 10), char('0' + year / 10 % 10), char('0' + year % 10),
+        '-', char('0' + date.month() / 10), char('0' + date.month() % 10),
+        '-', char('0' + date.day() / 10), char('0' + date.day() % 10),
+        '"'
+    };
+    out.append(buffer, sizeof(buffer));
+}
+
+void EntryJsonWriter::appendTime(QByteArray &out, const QTime &time)
+{
+    if (!time.isValid()) {
+        out.append("\"\"");
+        return;
+    }
+
+    const char buffer[7] = {
+        '"',
+        char('0' + time.hour() / 10), char('0' + time.hour() % 10),
+        ':', char('0' + time.minute() / 10), char('0' + time.minute() % 10),
+        '"'
+    };
+    out.append(buffer, sizeof(buffer));
+}
+
+// Длина value в UTF-8 с JSON-экранированием, без кавычек
+qsizetype EntryJsonWriter::escapedSize(QStringView value)
+{
+    const char16_t *s = value.utf16();
+    const qsizetype length = value.size();
+    qsizetype size = 0;
+    for (qsizetype i = 0; i < length; ++i) {
+        const char16_t c = s[i];
+        if (c < 0x80) {
+            if (c >= 0x20 && c != '"' && c != '\\')
+                size += 1;
+            else if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t' || c == '\b' || c == '\f')
+                size += 2;
+            else
+                size += 6;
+        } else if (c < 0x800) {
+            size += 2;
+        } else if (QChar::isHighSurrogate(c) && i + 1 < length && QChar::isLowSurrogate(s[i + 1])) {
+            size += 4;
+            ++i;
+        } else {
+            size += 3;
+        }
+    }
+    return size;
+}
+
+// UTF-16 -> UTF-8 с JSON-экранированием. Сначала считается точная длина
+// результата: так большой текст записи не раздувает буфер до худшего
+// случая (6 байт на символ) и помещается в запас, сделанный writeEntries().
+void EntryJsonWriter::appendString(QByteArray &out, QStringView value)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    const qsizetype start = out.size();
+    const qsizetype length = value.size();
+    out.resize(start + escapedSize(value) + 2);
+
+    char *d = out.data() + start;
+    const char16_t *s = value.utf16();
+
+    *d++ = '"';
+    for (qsizetype i = 0; i < length; ++i) {
+        const char16_t c = s[i];
+
+        if (c < 0x80) {
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                *d++ = char(c);
+                continue;
+            }
+            *d++ = '\\';
+            switch (c) {
+            case '"':  *d++ = '"'; break;
+            case '\\': *d++ = '\\'; break;
+            case '\n': *d++ = 'n'; break;
+            case '\r': *d++ = 'r'; break;
+            case '\t': *d++ = 't'; break;
+            case '\b': *d++ = 'b'; break;
+            case '\f': *d++ = 'f'; break;
+            default:
+                *d++ = 'u';
+                *d++ = '0';
+                *d++ = '0';
+                *d++ = hex[c >> 4];
+                *d++ = hex[c & 0xF];
+                break;
+            }
+        } else if (c < 0x800) {
+            *d++ = char(0xC0 | (c >> 6));
+            *d++ = char(0x80 | (c & 0x3F));
+        } else if (QChar::isHighSurrogate(c) && i + 1 < length && QChar::isLowSurrogate(s[i + 1])) {
+            const char32_t ucs4 = QChar::surrogateToUcs4(c, s[++i]);
+            *d++ = char(0xF0 | (ucs4 >> 18));
+            *d++ = char(0x80 | ((ucs4 >> 12) & 0x3F));
+            *d++ = char(0x80 | ((ucs4 >> 6) & 0x3F));
+            *d++ = char(0x80 | (ucs4 & 0x3F));
+        } else if (QChar::isSurrogate(c)) {
+            // одиночный суррогат — как QJsonDocument, заменяем на U+FFFD
+            *d++ = char(0xEF);
+            *d++ = char(0xBF);
+            *d++ = char(0xBD);
+        } else {
+            *d++ = char(0xE0 | (c >> 12));
+            *d++ = char(0x80 | ((c >> 6) & 0x3F));
+            *d++ = char(0x80 | (c & 0x3F));
+        }
+    }
+    *d++ = '"';
+
+    Q_ASSERT(d == out.constData() + out.size());
+}
@@ -0,0 +1,31 @@
+#ifndef ENTRYJSONWRITER_H
+#define ENTRYJSONWRITER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include "EntryUser.h"
+
+// Сериализация записей прямо в QByteArray, без промежуточных QJsonObject/QJsonArray.
+// Формат совпадает с тем, что раньше собирался через QJsonDocument:
+// {"entries":[{"id":..,"title":..,"content":..,"moodId":..,"folderId":..,
+//   "date":"yyyy-MM-dd","time":"HH:mm","tags":[..],"activities":[..],"emotions":[..]}],
+//  "nextCursor":".."}
+class EntryJsonWriter
+{
+public:
+    static QByteArray writeEntries(const QList<EntryUser> &entries, const QString &nextCursor = QString());
+
+    static void appendEntry(QByteArray &out, const EntryUser &entry);
+    static void appendString(QByteArray &out, QStringView value);
+    static void appendInt(QByteArray &out, qint64 value);
+
+private:
+    static void appendItems(QByteArray &out, const QVector<UserItem> &items);
+    static void appendDate(QByteArray &out, const QDate &date);
+    static void appendTime(QByteArray &out, const QTime &time);
+    static qsizetype escapedSize(QStringView value);
+};
+
+#endif // ENTRYJSONWRITER_H
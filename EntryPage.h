@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QDate>
+#include <QTime>
+#include <QList>
+#include "EntryUser.h"
+
+// Позиция в списке записей, упорядоченном по (entry_date, entry_time, id).
+// entry_time — time(3) NOT NULL (см. Database::ensureSchema), поэтому время
+// в курсоре всегда есть и миллисекунд достаточно, чтобы ключ совпал точно.
+struct EntryCursor {
+    QDate date;
+    QTime time;
+    int id = 0;
+
+    bool isValid() const { return id > 0 && date.isValid() && time.isValid(); }
+
+    QString encode() const {
+        const QString raw = QString("%1|%2|%3")
+                                .arg(date.toString(Qt::ISODate), time.toString("HH:mm:ss.zzz"))
+                                .arg(id);
+        return QString::fromLatin1(raw.toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+    }
+
+    static EntryCursor decode(const QString &text) {
+        EntryCursor cursor;
+        const QByteArray raw = QByteArray::fromBase64(text.toLatin1(), QByteArray::Base64UrlEncoding);
+        const QStringList parts = QString::fromUtf8(raw).split('|');
+        if (parts.size() != 3)
+            return cursor;
+
+        cursor.date = QDate::fromString(parts[0], Qt::ISODate);
+        cursor.time = QTime::fromString(parts[1], "HH:mm:ss.zzz");
+        cursor.id = parts[2].toInt();
+        return cursor;
+    }
+};
+
+struct PageRequest {
+    static constexpr int MaxLimit = 200;
+
+    int limit = 0;          // 0 — без ограничения, весь набор
+    EntryCursor after;      // пусто — с начала
+
+    bool isPaged() const { return limit > 0; }
+};
+
+struct EntryPage {
+    QList<EntryUser> entries;
+    QString nextCursor;     // пусто, если страница последняя
+};
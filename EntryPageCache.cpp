@@ -0,0 +1,138 @@
+#include "EntryPageCache.h"
+
+#include <QMutexLocker>
+
+namespace {
+
+// QHash, QString ключей и QByteArray вокруг самих данных
+constexpr qsizetype PageOverheadBytes = 96;
+
+} // namespace
+
+EntryPageCache &EntryPageCache::instance()
+{
+    static EntryPageCache *cache = new EntryPageCache;
+    return *cache;
+}
+
+EntryPageCache::EntryPageCache()
+{
+    m_months.setMaxCost(Config().maxBytes);
+}
+
+EntryPageCache::Config EntryPageCache::configFromEnvironment()
+{
+    Config config;
+
+    bool ok = false;
+    const int megabytes = qEnvironmentVariableIntValue("PSQLSERVER_ENTRY_CACHE_MB", &ok);
+    if (ok && megabytes >= 0)
+        config.maxBytes = qsizetype(megabytes) * 1024 * 1024;
+
+    return config;
+}
+
+void EntryPageCache::configure(const Config &config)
+{
+    QMutexLocker locker(&m_mutex);
+    m_months.setMaxCost(qMax<qsizetype>(config.maxBytes, 0));
+}
+
+QByteArray EntryPageCache::find(const Key &key)
+{
+    const QString month = monthKey(key.login, key.folderId, key.year, key.month);
+
+    QMutexLocker locker(&m_mutex);
+    // object() поднимает месяц в начало списка LRU
+    const Month *cached = m_months.object(month);
+    if (cached && cached->generation == m_users.value(key.login).generation) {
+        const auto page = cached->pages.constFind(pageKey(key));
+        if (page != cached->pages.constEnd()) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return *page;
+        }
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return QByteArray();
+}
+
+quint64 EntryPageCache::writeToken(const QString &login)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_users.value(login).writes;
+}
+
+void EntryPageCache::insert(const Key &key, const QByteArray &json, quint64 writeToken)
+{
+    const QString month = monthKey(key.login, key.folderId, key.year, key.month);
+    const QString page = pageKey(key);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_months.maxCost() <= 0)
+        return;
+
+    const UserState user = m_users.value(key.login);
+    if (user.writes != writeToken)
+        return;
+
+    Month *entry = m_months.take(month);
+    if (!entry || entry->generation != user.generation) {
+        delete entry;
+        entry = new Month;
+        entry->generation = user.generation;
+        entry->bytes = month.size() * qsizetype(sizeof(QChar));
+    }
+
+    const auto existing = entry->pages.constFind(page);
+    if (existing != entry->pages.constEnd())
+        entry->bytes -= existing->size() + page.size() * qsizetype(sizeof(QChar)) + PageOverheadBytes;
+    entry->pages.insert(page, json);
+    entry->bytes += json.size() + page.size() * qsizetype(sizeof(QChar)) + PageOverheadBytes;
+
+    // больше лимита QCache не примет и сам удалит entry
+    m_months.insert(month, entry, entry->bytes);
+}
+
+void EntryPageCache::invalidateMonth(const QString &login, int folderId, const QDate &date)
+{
+    if (!date.isValid())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    ++m_users[login].writes;
+    m_months.remove(monthKey(login, folderId, date.year(), date.month()));
+}
+
+void EntryPageCache::invalidateUser(const QString &login)
+{
+    // Месяцы пользователя не перечисляются: они сравнивают своё поколение
+    // с текущим при чтении, а устаревшие вытесняются LRU.
+    QMutexLocker locker(&m_mutex);
+    UserState &user = m_users[login];
+    ++user.generation;
+    ++user.writes;
+}
+
+EntryPageCache::Stats EntryPageCache::stats() const
+{
+    Stats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    stats.bytes = m_months.totalCost();
+    stats.maxBytes = m_months.maxCost();
+    stats.months = m_months.count();
+    return stats;
+}
+
+QString EntryPageCache::monthKey(const QString &login, int folderId, int year, int month)
+{
+    return QString("%1|%2|%3-%4").arg(login).arg(folderId).arg(year).arg(month);
+}
+
+QString EntryPageCache::pageKey(const Key &key)
+{
+    return QString::number(key.limit) + '|' + key.after;
+}
@@ -0,0 +1,88 @@
+#ifndef ENTRYPAGECACHE_H
+#define ENTRYPAGECACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QDate>
+#include <atomic>
+
+// Кэш готовых JSON-ответов /getuserentries за месяц папки.
+// Вытесняет давно не запрошенные месяцы (QCache, LRU) при превышении лимита
+// по памяти. Записи сбрасываются точно: сохранение, изменение и удаление
+// записи сбрасывают только затронутые месяцы папок, а изменения, видимые во
+// всех записях пользователя (удалённый тег, папка, сам пользователь), —
+// все месяцы этого пользователя.
+class EntryPageCache
+{
+public:
+    struct Config {
+        qsizetype maxBytes = 32 * 1024 * 1024;   // 0 — кэш выключен
+    };
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        qsizetype bytes = 0;
+        qsizetype maxBytes = 0;
+        qsizetype months = 0;
+    };
+
+    // Месяц папки и вариант страницы внутри него (размер страницы и курсор).
+    struct Key {
+        QString login;
+        int folderId = 0;
+        int year = 0;
+        int month = 0;
+        int limit = 0;
+        QString after;
+    };
+
+    static EntryPageCache &instance();
+
+    // PSQLSERVER_ENTRY_CACHE_MB=<n>
+    static Config configFromEnvironment();
+    void configure(const Config &config);
+
+    // Пустой QByteArray — промах
+    QByteArray find(const Key &key);
+
+    // Значение для insert(), которое нужно взять до чтения из базы: если
+    // пользователь успел что-то записать, прочитанная страница уже могла
+    // устареть и в кэш не попадёт.
+    quint64 writeToken(const QString &login);
+    void insert(const Key &key, const QByteArray &json, quint64 writeToken);
+
+    void invalidateMonth(const QString &login, int folderId, const QDate &date);
+    void invalidateUser(const QString &login);
+
+    Stats stats() const;
+
+private:
+    struct Month {
+        quint64 generation = 0;
+        QHash<QString, QByteArray> pages;   // ключ — "<limit>|<after>"
+        qsizetype bytes = 0;
+    };
+
+    struct UserState {
+        quint64 generation = 0;    // растёт при сбросе всех месяцев пользователя
+        quint64 writes = 0;        // растёт при любом сбросе
+    };
+
+    EntryPageCache();
+    Q_DISABLE_COPY(EntryPageCache)
+
+    static QString monthKey(const QString &login, int folderId, int year, int month);
+    static QString pageKey(const Key &key);
+
+    mutable QMutex m_mutex;
+    QCache<QString, Month> m_months;
+    QHash<QString, UserState> m_users;
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+};
+
+#endif // ENTRYPAGECACHE_H
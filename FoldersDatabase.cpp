@@ -1,14 +1,19 @@
 #include "FoldersDatabase.h"
+#include "DataVersions.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
+#include "EntriesDatabase.h"
 
 bool FoldersDatabase::saveUserFolder(const QString &login, const QStringList &folders)
 {
+    METRICS_QUERY_SCOPE("FoldersDatabase::saveUserFolder");
     if (folders.isEmpty())
         return false;
 
+    PooledConnection connection;
     for (const QString &folderName : folders) {
         // Проверка: существует ли уже такая папка у этого пользователя
-        QSqlQuery checkQuery;
-        checkQuery.prepare(R"(
+        QSqlQuery &checkQuery = connection.prepared(R"(
             SELECT 1 FROM folders
             WHERE name = :name AND user_login = :login
             LIMIT 1
@@ -25,8 +30,7 @@ bool FoldersDatabase::saveUserFolder(const QString &login, const QStringList &fo
         }
 
         // Вставка
-        QSqlQuery insertQuery;
-        insertQuery.prepare(R"(
+        QSqlQuery &insertQuery = connection.prepared(R"(
             INSERT INTO folders (name, user_login)
             VALUES (:name, :login)
         )");
@@ -36,6 +40,8 @@ bool FoldersDatabase::saveUserFolder(const QString &login, const QStringList &fo
             qWarning() << "Failed to insert folder:" << insertQuery.lastError().text();
             return false;
         }
+        // папки вставляются по одной, поэтому версия растёт после каждой
+        DataVersions::bump(login, DataVersions::Collection::Folders);
     }
 
     return true;
@@ -44,10 +50,11 @@ bool FoldersDatabase::saveUserFolder(const QString &login, const QStringList &fo
 
 QList<FoldersDatabase::FolderItem> FoldersDatabase::getUserFolders(const QString &login)
 {
+    METRICS_QUERY_SCOPE("FoldersDatabase::getUserFolders");
     QList<FolderItem> folders;
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT f.id, f.name, COUNT(e.id) AS itemcount
         FROM folders f
         LEFT JOIN entries e ON f.id = e.entry_folder_id
@@ -74,8 +81,15 @@ QList<FoldersDatabase::FolderItem> FoldersDatabase::getUserFolders(const QString
 
 bool FoldersDatabase::deleteFolder(const QString &login, const QString &folder)
 {
-    QSqlQuery countQuery;
-    countQuery.prepare(R"(
+    METRICS_QUERY_SCOPE("FoldersDatabase::deleteFolder");
+    PooledConnection connection;
+    DatabaseTransaction transaction(connection.database());
+    if (!transaction.isActive())
+        return false;
+    if (!EntriesDatabase::lockDailyMoodStats(connection, login))
+        return false;
+
+    QSqlQuery &countQuery = connection.prepared(R"(
         SELECT COUNT(*) FROM folders WHERE user_login = :login
     )");
 
@@ -92,8 +106,7 @@ bool FoldersDatabase::deleteFolder(const QString &login, const QString &folder)
     }
 
     // Удаление папки
-    QSqlQuery query;
-    query.prepare(R"(
+    QSqlQuery &query = connection.prepared(R"(
         DELETE FROM folders
         WHERE user_login = :login AND name = :folder
     )");
@@ -104,14 +117,25 @@ bool FoldersDatabase::deleteFolder(const QString &login, const QString &folder)
         return false;
     }
 
+    // записи папки удаляются вместе с ней, а в каких днях они были, заранее неизвестно
+    if (!EntriesDatabase::refreshDailyMoodStats(connection, login))
+        return false;
+
+    if (!transaction.commit())
+        return false;
+
+    DataVersions::bump(login, {DataVersions::Collection::Folders, DataVersions::Collection::Entries});
+    EntryPageCache::instance().invalidateUser(login);
+    MoodColumnsCache::instance().invalidateUser(login);
     return true;
 }
 
 
 bool FoldersDatabase::changeUserFolder(const QString &login, const QString &oldName, const QString &newName) {
+    METRICS_QUERY_SCOPE("FoldersDatabase::changeUserFolder");
 
-    QSqlQuery query;
-    query.prepare(R"(UPDATE folders
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(UPDATE folders
     SET name = :newName
     WHERE ctid IN (
         SELECT ctid FROM folders
@@ -133,6 +157,7 @@ bool FoldersDatabase::changeUserFolder(const QString &login, const QString &oldN
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Folders);
     qInfo() << "Folder name updated from" << oldName << "to" << newName << "for user:" << login;
     return true;
 }
@@ -1,5 +1,6 @@
 #include "FoldersDatabase.h"
 #include "FoldersManager.h"
+#include "DataVersions.h"
 
 FoldersManager::FoldersManager(QObject *parent)
     : QObject(parent)
@@ -82,6 +83,10 @@ QHttpServerResponse FoldersManager::handleGetUserFolders(const QHttpServerReques
         return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
     }
 
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Folders);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
+
     // Используем новую структуру и изменённый метод
     QList<FoldersDatabase::FolderItem> folders = FoldersDatabase::getUserFolders(login);
     qDebug() << "Folders fetched from DB:" << folders.size();
@@ -105,7 +110,9 @@ QHttpServerResponse FoldersManager::handleGetUserFolders(const QHttpServerReques
 
     response["folders"] = foldersArray;
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse httpResponse("application/json", QJsonDocument(response).toJson());
+    DataVersions::setETag(httpResponse, etag);
+    return httpResponse;
 }
 
 
@@ -0,0 +1,241 @@
+#include "Logger.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <chrono>
+#include <cstdint>
+
+std::atomic<Logger *> Logger::s_instance{nullptr};
+
+Logger::Logger(const Config &config)
+    : m_config(config)
+    , m_slots(new Slot[Capacity])
+{
+    for (std::size_t i = 0; i < Capacity; ++i)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_minSeverity.store(severity(m_config.minLevel), std::memory_order_relaxed);
+    applyFilterRules(m_config.minLevel);
+
+    m_writer = std::thread([this] { run(); });
+    s_instance.store(this, std::memory_order_release);
+    m_previousHandler = qInstallMessageHandler(&Logger::messageHandler);
+}
+
+Logger::~Logger()
+{
+    qInstallMessageHandler(m_previousHandler);
+    s_instance.store(nullptr, std::memory_order_release);
+
+    m_stopping.store(true, std::memory_order_release);
+    m_wake.notify_one();
+    m_writer.join();
+
+    const Stats totals = stats();
+    if (totals.dropped > 0 || totals.suppressed > 0) {
+        std::fprintf(stderr, "Logger: %llu messages dropped (queue full), %llu suppressed by rate limit\n",
+                     static_cast<unsigned long long>(totals.dropped),
+                     static_cast<unsigned long long>(totals.suppressed));
+    }
+}
+
+Logger::Config Logger::configFromEnvironment()
+{
+    Config config;
+
+#ifdef QT_NO_DEBUG_OUTPUT
+    config.minLevel = QtInfoMsg;
+#endif
+
+    const QString level = qEnvironmentVariable("PSQLSERVER_LOG_LEVEL").trimmed().toLower();
+    if (level == "debug")
+        config.minLevel = QtDebugMsg;
+    else if (level == "info")
+        config.minLevel = QtInfoMsg;
+    else if (level == "warning")
+        config.minLevel = QtWarningMsg;
+    else if (level == "critical")
+        config.minLevel = QtCriticalMsg;
+
+    bool ok = false;
+    const int rate = qEnvironmentVariableIntValue("PSQLSERVER_LOG_RATE", &ok);
+    if (ok && rate >= 0)
+        config.perSiteLimit = rate;
+
+    return config;
+}
+
+void Logger::setLevel(QtMsgType level)
+{
+    if (Logger *logger = s_instance.load(std::memory_order_acquire))
+        logger->m_minSeverity.store(severity(level), std::memory_order_relaxed);
+    applyFilterRules(level);
+}
+
+Logger::Stats Logger::stats()
+{
+    Stats result;
+    if (Logger *logger = s_instance.load(std::memory_order_acquire)) {
+        result.written = logger->m_written.load(std::memory_order_relaxed);
+        result.dropped = logger->m_dropped.load(std::memory_order_relaxed);
+        result.suppressed = logger->m_suppressed.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+int Logger::severity(QtMsgType type)
+{
+    switch (type) {
+    case QtDebugMsg:    return 0;
+    case QtInfoMsg:     return 1;
+    case QtWarningMsg:  return 2;
+    case QtCriticalMsg: return 3;
+    case QtFatalMsg:    return 4;
+    }
+    return 4;
+}
+
+void Logger::applyFilterRules(QtMsgType level)
+{
+    // Отключённые через правила категории отсекаются ещё в qDebug()/qCDebug(),
+    // до форматирования аргументов, — это дешевле, чем отбрасывать готовую строку.
+    QStringList rules;
+    const int minSeverity = severity(level);
+    if (minSeverity > severity(QtDebugMsg))
+        rules << "*.debug=false";
+    if (minSeverity > severity(QtInfoMsg))
+        rules << "*.info=false";
+    if (minSeverity > severity(QtWarningMsg))
+        rules << "*.warning=false";
+    QLoggingCategory::setFilterRules(rules.join('\n'));
+}
+
+void Logger::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    Record record;
+    record.type = type;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    record.category = context.category;
+    record.file = context.file;
+    record.line = context.line;
+    record.message = message;
+
+    Logger *logger = s_instance.load(std::memory_order_acquire);
+    if (!logger || type == QtFatalMsg) {
+        // после fatal процесс завершается, поэтому пишем сразу
+        writeRecord(record, stderr);
+        std::fflush(stderr);
+        return;
+    }
+
+    if (severity(type) < logger->m_minSeverity.load(std::memory_order_relaxed))
+        return;
+
+    if (type != QtCriticalMsg && !logger->allowSite(context.file, context.line, record.timestampMs)) {
+        logger->m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!logger->enqueue(std::move(record)))
+        logger->m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Logger::allowSite(const char *file, int line, qint64 nowMs)
+{
+    if (m_config.perSiteLimit <= 0 || !file)
+        return true;
+
+    // file — строковый литерал __FILE__, его адрес постоянен для места вызова.
+    // Разные места изредка делят один счётчик; для ограничителя это допустимо.
+    const quintptr key = reinterpret_cast<quintptr>(file) ^ (quintptr(line) * 0x9E3779B1u);
+    SiteCounter &site = m_sites[(key ^ (key >> 12)) % m_sites.size()];
+
+    const qint64 second = nowMs / 1000;
+    qint64 current = site.second.load(std::memory_order_relaxed);
+    if (current != second && site.second.compare_exchange_strong(current, second, std::memory_order_relaxed))
+        site.count.store(0, std::memory_order_relaxed);
+
+    return site.count.fetch_add(1, std::memory_order_relaxed) < m_config.perSiteLimit;
+}
+
+bool Logger::enqueue(Record &&record)
+{
+    std::size_t position = m_tail.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+        slot = &m_slots[position & (Capacity - 1)];
+        const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const std::intptr_t difference = std::intptr_t(sequence) - std::intptr_t(position);
+        if (difference == 0) {
+            if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = std::move(record);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool Logger::dequeue(Record &record)
+{
+    Slot &slot = m_slots[m_head & (Capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+        return false;
+
+    record = std::move(slot.record);
+    slot.record.message = QString();
+    slot.sequence.store(m_head + Capacity, std::memory_order_release);
+    ++m_head;
+    return true;
+}
+
+void Logger::run()
+{
+    Record record;
+    for (;;) {
+        // флаг читается до разбора очереди, чтобы после остановки
+        // гарантированно был ещё один полный проход
+        const bool stopping = m_stopping.load(std::memory_order_acquire);
+
+        bool wroteAny = false;
+        while (dequeue(record)) {
+            writeRecord(record, stderr);
+            m_written.fetch_add(1, std::memory_order_relaxed);
+            wroteAny = true;
+        }
+        if (wroteAny)
+            std::fflush(stderr);
+
+        if (stopping)
+            break;
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_config.flushIntervalMs));
+    }
+}
+
+void Logger::writeRecord(const Record &record, FILE *out)
+{
+    static const char *const levels[] = { "D", "W", "C", "F", "I" };
+    const int typeIndex = int(record.type);
+
+    QByteArray line;
+    line.reserve(64 + record.message.size() * 2);
+    line.append(QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1());
+    line.append(" [").append(typeIndex >= 0 && typeIndex <= 4 ? levels[typeIndex] : "?").append("] ");
+    if (record.category && qstrcmp(record.category, "default") != 0)
+        line.append(record.category).append(": ");
+    line.append(record.message.toUtf8());
+    if (record.type >= QtWarningMsg && record.type != QtInfoMsg && record.file)
+        line.append(" (").append(record.file).append(':').append(QByteArray::number(record.line)).append(')');
+    line.append('\n');
+
+    std::fwrite(line.constData(), 1, size_t(line.size()), out);
+}
@@ -0,0 +1,97 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <cstdio>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Асинхронный вывод qDebug/qInfo/qWarning/qCritical.
+// Обработчик сообщений Qt только кладёт запись в ограниченное кольцо
+// (Vyukov MPSC, без блокировок), а форматирует и пишет в stderr отдельный
+// поток. При переполнении кольца сообщение отбрасывается, а не ждёт:
+// логирование не должно задерживать обработку запросов.
+class Logger
+{
+public:
+    struct Config {
+        QtMsgType minLevel = QtDebugMsg;   // сообщения ниже этого уровня не пишутся
+        int perSiteLimit = 50;             // сообщений в секунду с одной строки кода, 0 — без ограничения
+        int flushIntervalMs = 20;
+    };
+
+    struct Stats {
+        quint64 written = 0;
+        quint64 dropped = 0;               // кольцо было заполнено
+        quint64 suppressed = 0;            // сработало ограничение частоты
+    };
+
+    explicit Logger(const Config &config);
+    ~Logger();
+
+    // PSQLSERVER_LOG_LEVEL=debug|info|warning|critical, PSQLSERVER_LOG_RATE=<n>
+    static Config configFromEnvironment();
+
+    static void setLevel(QtMsgType level);
+    static Stats stats();
+
+private:
+    static constexpr std::size_t Capacity = 8192;  // степень двойки
+
+    struct Record {
+        QtMsgType type = QtDebugMsg;
+        qint64 timestampMs = 0;
+        const char *category = nullptr;
+        const char *file = nullptr;
+        int line = 0;
+        QString message;
+    };
+
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        Record record;
+    };
+
+    struct SiteCounter {
+        std::atomic<qint64> second{0};
+        std::atomic<int> count{0};
+    };
+
+    Q_DISABLE_COPY(Logger)
+
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message);
+    static int severity(QtMsgType type);
+    static void applyFilterRules(QtMsgType level);
+    static void writeRecord(const Record &record, FILE *out);
+
+    bool allowSite(const char *file, int line, qint64 nowMs);
+    bool enqueue(Record &&record);
+    bool dequeue(Record &record);
+    void run();
+
+    Config m_config;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<std::size_t> m_tail{0};
+    std::size_t m_head = 0;                      // читает только поток записи
+    std::array<SiteCounter, 1024> m_sites;
+
+    std::atomic<int> m_minSeverity{0};
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_suppressed{0};
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_stopping{false};
+    std::thread m_writer;
+    QtMessageHandler m_previousHandler = nullptr;
+
+    static std::atomic<Logger *> s_instance;
+};
+
+#endif // LOGGER_H
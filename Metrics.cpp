@@ -0,0 +1,193 @@
+#include "Metrics.h"
+#include "ConnectionPool.h"
+#include "Logger.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
+
+namespace {
+
+void appendSeconds(QByteArray &out, quint64 nanoseconds)
+{
+    out.append(QByteArray::number(double(nanoseconds) / 1e9, 'g', 9));
+}
+
+void appendMetricHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+    out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+}
+
+} // namespace
+
+void LatencyHistogram::observe(qint64 nanoseconds)
+{
+    const quint64 value = nanoseconds > 0 ? quint64(nanoseconds) : 0;
+
+    std::size_t bucket = 0;
+    while (bucket < Bounds.size() && value > Bounds[bucket])
+        ++bucket;
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add(value, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::render(QByteArray &out, const QByteArray &name, const QByteArray &labels) const
+{
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+
+    quint64 cumulative = 0;
+    for (std::size_t i = 0; i < Bounds.size(); ++i) {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        out.append(name).append("_bucket{").append(prefix).append("le=\"");
+        appendSeconds(out, Bounds[i]);
+        out.append("\"} ").append(QByteArray::number(cumulative)).append('\n');
+    }
+    cumulative += m_buckets[Bounds.size()].load(std::memory_order_relaxed);
+    out.append(name).append("_bucket{").append(prefix).append("le=\"+Inf\"} ")
+        .append(QByteArray::number(cumulative)).append('\n');
+
+    out.append(name).append("_sum{").append(labels).append("} ");
+    appendSeconds(out, m_sumNs.load(std::memory_order_relaxed));
+    out.append('\n');
+    out.append(name).append("_count{").append(labels).append("} ")
+        .append(QByteArray::number(m_count.load(std::memory_order_relaxed))).append('\n');
+}
+
+void RouteMetrics::record(qint64 requestSize, int statusCode, qint64 responseSize, qint64 nanoseconds)
+{
+    const int statusClass = statusCode / 100;
+    statusClasses[statusClass >= 1 && statusClass <= 5 ? statusClass : 0].fetch_add(1, std::memory_order_relaxed);
+    requestBytes.fetch_add(quint64(qMax<qint64>(0, requestSize)), std::memory_order_relaxed);
+    responseBytes.fetch_add(quint64(qMax<qint64>(0, responseSize)), std::memory_order_relaxed);
+    latency.observe(nanoseconds);
+}
+
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+RouteMetrics *Metrics::route(const QString &path, const QByteArray &method)
+{
+    QMutexLocker locker(&m_mutex);
+    const QByteArray utf8Path = path.toUtf8();
+    for (RouteMetrics &route : m_routes) {
+        if (route.path == utf8Path && route.method == method)
+            return &route;
+    }
+
+    RouteMetrics &route = m_routes.emplace_back();
+    route.path = utf8Path;
+    route.method = method;
+    return &route;
+}
+
+QueryMetrics &Metrics::query(const char *name)
+{
+    QMutexLocker locker(&m_mutex);
+    for (QueryMetrics &query : m_queries) {
+        if (query.name == name)
+            return query;
+    }
+
+    QueryMetrics &query = m_queries.emplace_back();
+    query.name = name;
+    return query;
+}
+
+QByteArray Metrics::render() const
+{
+    static const char *const statusLabels[] = { "other", "1xx", "2xx", "3xx", "4xx", "5xx" };
+
+    QByteArray out;
+    out.reserve(64 * 1024);
+
+    QMutexLocker locker(&m_mutex);
+
+    appendMetricHeader(out, "psqlserver_http_requests_total", "counter", "HTTP requests by route and status class.");
+    for (const RouteMetrics &route : m_routes) {
+        for (std::size_t i = 0; i < route.statusClasses.size(); ++i) {
+            const quint64 count = route.statusClasses[i].load(std::memory_order_relaxed);
+            if (count == 0)
+                continue;
+            out.append("psqlserver_http_requests_total{route=\"").append(route.path)
+                .append("\",method=\"").append(route.method)
+                .append("\",code=\"").append(statusLabels[i]).append("\"} ")
+                .append(QByteArray::number(count)).append('\n');
+        }
+    }
+
+    appendMetricHeader(out, "psqlserver_http_request_bytes_total", "counter", "Request body bytes received.");
+    for (const RouteMetrics &route : m_routes) {
+        out.append("psqlserver_http_request_bytes_total{route=\"").append(route.path)
+            .append("\",method=\"").append(route.method).append("\"} ")
+            .append(QByteArray::number(route.requestBytes.load(std::memory_order_relaxed))).append('\n');
+    }
+
+    appendMetricHeader(out, "psqlserver_http_response_bytes_total", "counter", "Response body bytes sent.");
+    for (const RouteMetrics &route : m_routes) {
+        out.append("psqlserver_http_response_bytes_total{route=\"").append(route.path)
+            .append("\",method=\"").append(route.method).append("\"} ")
+            .append(QByteArray::number(route.responseBytes.load(std::memory_order_relaxed))).append('\n');
+    }
+
+    appendMetricHeader(out, "psqlserver_http_request_duration_seconds", "histogram",
+                       "Time from routing to a ready response, including the wait for a worker.");
+    for (const RouteMetrics &route : m_routes) {
+        route.latency.render(out, "psqlserver_http_request_duration_seconds",
+                             "route=\"" + route.path + "\",method=\"" + route.method + '"');
+    }
+
+    appendMetricHeader(out, "psqlserver_db_query_duration_seconds", "histogram", "Time spent in *Database calls.");
+    for (const QueryMetrics &query : m_queries) {
+        query.latency.render(out, "psqlserver_db_query_duration_seconds", "query=\"" + query.name + '"');
+    }
+
+    const ConnectionPool::Stats pool = ConnectionPool::instance().stats();
+    appendMetricHeader(out, "psqlserver_db_pool_connections", "gauge", "Pooled database connections.");
+    out.append("psqlserver_db_pool_connections{state=\"open\"} ").append(QByteArray::number(pool.open)).append('\n');
+    out.append("psqlserver_db_pool_connections{state=\"in_use\"} ").append(QByteArray::number(pool.inUse)).append('\n');
+    out.append("psqlserver_db_pool_connections{state=\"peak\"} ").append(QByteArray::number(pool.peak)).append('\n');
+    appendMetricHeader(out, "psqlserver_db_pool_events_total", "counter", "Connection pool events.");
+    out.append("psqlserver_db_pool_events_total{event=\"checkout\"} ").append(QByteArray::number(pool.checkouts)).append('\n');
+    out.append("psqlserver_db_pool_events_total{event=\"wait\"} ").append(QByteArray::number(pool.waits)).append('\n');
+    out.append("psqlserver_db_pool_events_total{event=\"reconnect\"} ").append(QByteArray::number(pool.reconnects)).append('\n');
+    out.append("psqlserver_db_pool_events_total{event=\"failure\"} ").append(QByteArray::number(pool.failures)).append('\n');
+    appendMetricHeader(out, "psqlserver_db_statement_cache_total", "counter", "Prepared statement cache lookups.");
+    out.append("psqlserver_db_statement_cache_total{result=\"hit\"} ").append(QByteArray::number(pool.statementHits)).append('\n');
+    out.append("psqlserver_db_statement_cache_total{result=\"miss\"} ").append(QByteArray::number(pool.statementMisses)).append('\n');
+
+    const EntryPageCache::Stats entryCache = EntryPageCache::instance().stats();
+    const quint64 entryCacheLookups = entryCache.hits + entryCache.misses;
+    appendMetricHeader(out, "psqlserver_entry_page_cache_total", "counter", "Month entry page cache lookups.");
+    out.append("psqlserver_entry_page_cache_total{result=\"hit\"} ").append(QByteArray::number(entryCache.hits)).append('\n');
+    out.append("psqlserver_entry_page_cache_total{result=\"miss\"} ").append(QByteArray::number(entryCache.misses)).append('\n');
+    appendMetricHeader(out, "psqlserver_entry_page_cache_hit_ratio", "gauge", "Share of lookups served from the cache since start.");
+    out.append("psqlserver_entry_page_cache_hit_ratio ")
+        .append(QByteArray::number(entryCacheLookups ? double(entryCache.hits) / double(entryCacheLookups) : 0.0, 'g', 6)).append('\n');
+    appendMetricHeader(out, "psqlserver_entry_page_cache_bytes", "gauge", "Approximate memory held by cached pages.");
+    out.append("psqlserver_entry_page_cache_bytes{kind=\"used\"} ").append(QByteArray::number(entryCache.bytes)).append('\n');
+    out.append("psqlserver_entry_page_cache_bytes{kind=\"limit\"} ").append(QByteArray::number(entryCache.maxBytes)).append('\n');
+    appendMetricHeader(out, "psqlserver_entry_page_cache_months", "gauge", "Cached folder months.");
+    out.append("psqlserver_entry_page_cache_months ").append(QByteArray::number(entryCache.months)).append('\n');
+
+    const MoodColumnsCache::Stats moodCache = MoodColumnsCache::instance().stats();
+    appendMetricHeader(out, "psqlserver_mood_cache_total", "counter", "Columnar mood history lookups.");
+    out.append("psqlserver_mood_cache_total{result=\"hit\"} ").append(QByteArray::number(moodCache.hits)).append('\n');
+    out.append("psqlserver_mood_cache_total{result=\"miss\"} ").append(QByteArray::number(moodCache.misses)).append('\n');
+    appendMetricHeader(out, "psqlserver_mood_cache_bytes", "gauge", "Memory held by cached mood columns.");
+    out.append("psqlserver_mood_cache_bytes{kind=\"used\"} ").append(QByteArray::number(moodCache.bytes)).append('\n');
+    out.append("psqlserver_mood_cache_bytes{kind=\"limit\"} ").append(QByteArray::number(moodCache.maxBytes)).append('\n');
+    appendMetricHeader(out, "psqlserver_mood_cache_users", "gauge", "Users with cached mood history.");
+    out.append("psqlserver_mood_cache_users ").append(QByteArray::number(moodCache.users)).append('\n');
+
+    const Logger::Stats log = Logger::stats();
+    appendMetricHeader(out, "psqlserver_log_messages_total", "counter", "Log messages by outcome.");
+    out.append("psqlserver_log_messages_total{result=\"written\"} ").append(QByteArray::number(log.written)).append('\n');
+    out.append("psqlserver_log_messages_total{result=\"dropped\"} ").append(QByteArray::number(log.dropped)).append('\n');
+    out.append("psqlserver_log_messages_total{result=\"suppressed\"} ").append(QByteArray::number(log.suppressed)).append('\n');
+
+    return out;
+}
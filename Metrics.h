@@ -0,0 +1,96 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <deque>
+#include "Trace.h"
+
+// Счётчики для GET /metrics (текстовый формат Prometheus).
+// Все обновления — relaxed-атомики без блокировок; мьютекс берётся только
+// при регистрации нового маршрута или запроса и при формировании ответа.
+class LatencyHistogram
+{
+public:
+    // верхние границы корзин в наносекундах: 0.5 мс ... 10 с, последняя — +Inf
+    static constexpr std::array<quint64, 14> Bounds = {
+        500000ull, 1000000ull, 2500000ull, 5000000ull, 10000000ull, 25000000ull, 50000000ull,
+        100000000ull, 250000000ull, 500000000ull, 1000000000ull, 2500000000ull, 5000000000ull, 10000000000ull
+    };
+
+    void observe(qint64 nanoseconds);
+    void render(QByteArray &out, const QByteArray &name, const QByteArray &labels) const;
+
+private:
+    std::array<std::atomic<quint64>, Bounds.size() + 1> m_buckets{};
+    std::atomic<quint64> m_sumNs{0};
+    std::atomic<quint64> m_count{0};
+};
+
+struct RouteMetrics {
+    QByteArray path;
+    QByteArray method;
+    std::array<std::atomic<quint64>, 6> statusClasses{};  // [1..5] — 1xx..5xx, [0] — прочие
+    std::atomic<quint64> requestBytes{0};
+    std::atomic<quint64> responseBytes{0};
+    LatencyHistogram latency;
+
+    void record(qint64 requestSize, int statusCode, qint64 responseSize, qint64 nanoseconds);
+};
+
+struct QueryMetrics {
+    QByteArray name;
+    LatencyHistogram latency;
+};
+
+class Metrics
+{
+public:
+    static Metrics &instance();
+
+    // Возвращаемые указатели живут до конца процесса, их можно кэшировать.
+    RouteMetrics *route(const QString &path, const QByteArray &method);
+    QueryMetrics &query(const char *name);
+
+    QByteArray render() const;
+
+private:
+    Metrics() = default;
+    Q_DISABLE_COPY(Metrics)
+
+    mutable QMutex m_mutex;
+    std::deque<RouteMetrics> m_routes;
+    std::deque<QueryMetrics> m_queries;
+};
+
+// Замер одного обращения к базе в *Database функции; при включённой
+// трассировке он же становится спаном с именем функции.
+class QueryTimer
+{
+public:
+    explicit QueryTimer(QueryMetrics &metrics)
+        : m_metrics(metrics)
+        , m_span(metrics.name.constData())
+    {
+        m_timer.start();
+    }
+    ~QueryTimer() { m_metrics.latency.observe(m_timer.nsecsElapsed()); }
+
+private:
+    Q_DISABLE_COPY(QueryTimer)
+    QueryMetrics &m_metrics;
+    TraceSpan m_span;
+    QElapsedTimer m_timer;
+};
+
+// Ставится первой строкой функции: регистрация происходит один раз (static),
+// дальше остаётся только QElapsedTimer и несколько атомарных инкрементов.
+#define METRICS_QUERY_SCOPE(name) \
+    static QueryMetrics &metricsQuery_ = Metrics::instance().query(name); \
+    QueryTimer metricsQueryTimer_(metricsQuery_)
+
+#endif // METRICS_H
@@ -0,0 +1,127 @@
+#ifndef MOODCOLUMNS_H
+#define MOODCOLUMNS_H
+
+#include <QDate>
+#include <QList>
+#include <QTime>
+#include <QtGlobal>
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Записи пользователя по столбцам, только то, что нужно аналитике.
+// Порядок — (entry_date, entry_time, id). Связи i-й записи лежат в
+// activityIds[activityOffsets[i]; activityOffsets[i + 1]), так же эмоции.
+struct MoodColumns {
+    std::vector<qint32> entryIds;
+    std::vector<qint32> days;               // QDate::toJulianDay()
+    std::vector<qint32> times;              // QTime::msecsSinceStartOfDay(), нужно только для порядка
+    std::vector<qint8> moods;
+    std::vector<quint32> activityOffsets{0};
+    std::vector<qint32> activityIds;
+    std::vector<quint32> emotionOffsets{0};
+    std::vector<qint32> emotionIds;
+
+    std::size_t size() const { return moods.size(); }
+
+    // Запись должна идти после всех уже добавленных (так читает loadMoodColumns)
+    void append(int entryId, const QDate &date, const QTime &time, int mood, const QList<int> &activities,
+                const QList<int> &emotions)
+    {
+        entryIds.push_back(entryId);
+        days.push_back(qint32(date.toJulianDay()));
+        times.push_back(timeKey(time));
+        moods.push_back(qint8(qBound(-128, mood, 127)));
+        activityIds.insert(activityIds.end(), activities.cbegin(), activities.cend());
+        activityOffsets.push_back(quint32(activityIds.size()));
+        emotionIds.insert(emotionIds.end(), emotions.cbegin(), emotions.cend());
+        emotionOffsets.push_back(quint32(emotionIds.size()));
+    }
+
+    // Вставка на место по (entry_date, entry_time, id)
+    void insert(int entryId, const QDate &date, const QTime &time, int mood, const QList<int> &activities,
+                const QList<int> &emotions)
+    {
+        const qint32 day = qint32(date.toJulianDay());
+        const qint32 msecs = timeKey(time);
+        std::size_t at = 0;
+        std::size_t last = size();
+        while (at < last) {
+            const std::size_t mid = at + (last - at) / 2;
+            if (std::make_tuple(days[mid], times[mid], entryIds[mid]) < std::make_tuple(day, msecs, qint32(entryId)))
+                at = mid + 1;
+            else
+                last = mid;
+        }
+        if (at == size()) {
+            append(entryId, date, time, mood, activities, emotions);
+            return;
+        }
+
+        entryIds.insert(entryIds.begin() + std::ptrdiff_t(at), entryId);
+        days.insert(days.begin() + std::ptrdiff_t(at), day);
+        times.insert(times.begin() + std::ptrdiff_t(at), msecs);
+        moods.insert(moods.begin() + std::ptrdiff_t(at), qint8(qBound(-128, mood, 127)));
+        insertRelations(activityOffsets, activityIds, at, activities);
+        insertRelations(emotionOffsets, emotionIds, at, emotions);
+    }
+
+    bool remove(int entryId)
+    {
+        const auto it = std::find(entryIds.cbegin(), entryIds.cend(), qint32(entryId));
+        if (it == entryIds.cend())
+            return false;
+
+        const std::size_t at = std::size_t(it - entryIds.cbegin());
+        entryIds.erase(entryIds.begin() + std::ptrdiff_t(at));
+        days.erase(days.begin() + std::ptrdiff_t(at));
+        times.erase(times.begin() + std::ptrdiff_t(at));
+        moods.erase(moods.begin() + std::ptrdiff_t(at));
+        removeRelations(activityOffsets, activityIds, at);
+        removeRelations(emotionOffsets, emotionIds, at);
+        return true;
+    }
+
+    qsizetype memoryBytes() const
+    {
+        return qsizetype((entryIds.capacity() + days.capacity() + times.capacity()) * sizeof(qint32)
+                         + moods.capacity() * sizeof(qint8)
+                         + (activityOffsets.capacity() + emotionOffsets.capacity()) * sizeof(quint32)
+                         + (activityIds.capacity() + emotionIds.capacity()) * sizeof(qint32));
+    }
+
+    // Индексы [first; last) записей с датой в [from; to)
+    std::pair<std::size_t, std::size_t> range(const QDate &from, const QDate &to) const
+    {
+        const auto first = std::lower_bound(days.cbegin(), days.cend(), qint32(from.toJulianDay()));
+        const auto last = std::lower_bound(first, days.cend(), qint32(to.toJulianDay()));
+        return { std::size_t(first - days.cbegin()), std::size_t(last - days.cbegin()) };
+    }
+
+private:
+    // entry_time — NOT NULL, недействительное время встаёт в начало дня, как полночь
+    static qint32 timeKey(const QTime &time) { return time.isValid() ? time.msecsSinceStartOfDay() : 0; }
+
+    static void insertRelations(std::vector<quint32> &offsets, std::vector<qint32> &ids, std::size_t at,
+                                const QList<int> &values)
+    {
+        const quint32 begin = offsets[at];
+        ids.insert(ids.begin() + std::ptrdiff_t(begin), values.cbegin(), values.cend());
+        offsets.insert(offsets.begin() + std::ptrdiff_t(at) + 1, begin + quint32(values.size()));
+        for (std::size_t i = at + 2; i < offsets.size(); ++i)
+            offsets[i] += quint32(values.size());
+    }
+
+    static void removeRelations(std::vector<quint32> &offsets, std::vector<qint32> &ids, std::size_t at)
+    {
+        const quint32 begin = offsets[at];
+        const quint32 count = offsets[at + 1] - begin;
+        ids.erase(ids.begin() + std::ptrdiff_t(begin), ids.begin() + std::ptrdiff_t(begin + count));
+        offsets.erase(offsets.begin() + std::ptrdiff_t(at) + 1);
+        for (std::size_t i = at + 1; i < offsets.size(); ++i)
+            offsets[i] -= count;
+    }
+};
+
+#endif // MOODCOLUMNS_H
@@ -0,0 +1,173 @@
+#include "MoodColumnsCache.h"
+#include "ComputeDatabase.h"
+
+#include <QMutexLocker>
+
+MoodColumnsCache &MoodColumnsCache::instance()
+{
+    static MoodColumnsCache *cache = new MoodColumnsCache;
+    return *cache;
+}
+
+MoodColumnsCache::MoodColumnsCache()
+{
+    m_users.setMaxCost(Config().maxBytes);
+}
+
+MoodColumnsCache::Config MoodColumnsCache::configFromEnvironment()
+{
+    Config config;
+
+    bool ok = false;
+    const int megabytes = qEnvironmentVariableIntValue("PSQLSERVER_MOOD_CACHE_MB", &ok);
+    if (ok && megabytes >= 0)
+        config.maxBytes = qsizetype(megabytes) * 1024 * 1024;
+
+    return config;
+}
+
+void MoodColumnsCache::configure(const Config &config)
+{
+    QMutexLocker locker(&m_mutex);
+    m_users.setMaxCost(qMax<qsizetype>(config.maxBytes, 0));
+}
+
+bool MoodColumnsCache::isEnabled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_users.maxCost() > 0;
+}
+
+std::shared_ptr<const MoodColumns> MoodColumnsCache::columns(const QString &login)
+{
+    quint64 token = 0;
+    quint64 loadStamp = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const Entry *cached = m_users.object(login)) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return cached->columns;
+        }
+        Loads &loads = m_loads[login];
+        ++loads.pending;
+        token = loads.writes;
+        loadStamp = ++m_clock;
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Читаем без блокировки: загрузка истории — самый долгий шаг
+    bool ok = false;
+    auto loaded = std::make_shared<MoodColumns>(ComputeDatabase::loadMoodColumns(login, QDate(), QDate(), &ok));
+
+    QMutexLocker locker(&m_mutex);
+    const auto loads = m_loads.find(login);
+    const bool written = loads->writes != token;
+    if (--loads->pending == 0)
+        m_loads.erase(loads);
+
+    if (!ok)
+        return nullptr;
+    if (m_users.maxCost() <= 0 || written)
+        return loaded;
+    if (const Entry *cached = m_users.object(login))
+        return cached->columns;
+
+    Entry *entry = new Entry{loaded, loadStamp};
+    // больше лимита QCache не примет и сам удалит entry
+    m_users.insert(login, entry, loaded->memoryBytes());
+    return loaded;
+}
+
+quint64 MoodColumnsCache::writeStamp()
+{
+    QMutexLocker locker(&m_mutex);
+    return ++m_clock;
+}
+
+// Загрузка с меньшим номером могла прочитать базу уже после коммита и увидеть
+// изменение, поэтому изменения идемпотентны: прежняя версия записи удаляется.
+void MoodColumnsCache::entrySaved(const QString &login, quint64 stamp, int entryId, const QDate &date,
+                                  const QTime &time, int mood, const QList<int> &activities,
+                                  const QList<int> &emotions)
+{
+    entryUpdated(login, stamp, entryId, date, time, mood, activities, emotions);
+}
+
+void MoodColumnsCache::entryUpdated(const QString &login, quint64 stamp, int entryId, const QDate &date,
+                                    const QTime &time, int mood, const QList<int> &activities,
+                                    const QList<int> &emotions)
+{
+    QMutexLocker locker(&m_mutex);
+    noteWrite(login);
+    if (MoodColumns *columns = mutableColumns(login, stamp)) {
+        // дата и время могли измениться, поэтому запись встаёт на новое место
+        columns->remove(entryId);
+        columns->insert(entryId, date, time, mood, activities, emotions);
+        updateCost(login);
+    }
+}
+
+void MoodColumnsCache::entryRemoved(const QString &login, quint64 stamp, int entryId)
+{
+    QMutexLocker locker(&m_mutex);
+    noteWrite(login);
+    if (MoodColumns *columns = mutableColumns(login, stamp)) {
+        columns->remove(entryId);
+        updateCost(login);
+    }
+}
+
+void MoodColumnsCache::invalidateUser(const QString &login)
+{
+    QMutexLocker locker(&m_mutex);
+    noteWrite(login);
+    m_users.remove(login);
+}
+
+MoodColumnsCache::Stats MoodColumnsCache::stats() const
+{
+    Stats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_mutex);
+    stats.bytes = m_users.totalCost();
+    stats.maxBytes = m_users.maxCost();
+    stats.users = m_users.count();
+    return stats;
+}
+
+MoodColumns *MoodColumnsCache::mutableColumns(const QString &login, quint64 stamp)
+{
+    Entry *entry = m_users.object(login);
+    if (!entry)
+        return nullptr;
+
+    // Более позднее изменение уже применено, или загрузка началась после
+    // номера и могла как увидеть это изменение, так и нет.
+    if (stamp <= entry->stamp) {
+        m_users.remove(login);
+        return nullptr;
+    }
+    entry->stamp = stamp;
+
+    // Снимки раздаются только под m_mutex, поэтому единственный владелец
+    // не может появиться у читателя, пока идёт изменение.
+    if (entry->columns.use_count() > 1)
+        entry->columns = std::make_shared<MoodColumns>(*entry->columns);
+    return entry->columns.get();
+}
+
+void MoodColumnsCache::updateCost(const QString &login)
+{
+    Entry *entry = m_users.take(login);
+    if (entry)
+        m_users.insert(login, entry, entry->columns->memoryBytes());
+}
+
+void MoodColumnsCache::noteWrite(const QString &login)
+{
+    const auto loads = m_loads.find(login);
+    if (loads != m_loads.end())
+        ++loads->writes;
+}
@@ -0,0 +1,99 @@
+#ifndef MOODCOLUMNSCACHE_H
+#define MOODCOLUMNSCACHE_H
+
+#include <QCache>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QTime>
+#include <atomic>
+#include <memory>
+#include "MoodColumns.h"
+
+// Колоночная история настроения активных пользователей (MoodColumns).
+// Загружается из PostgreSQL целиком при первом обращении, дальше
+// поддерживается путями записи EntriesDatabase, так что аналитика и
+// загрузка по месяцам идут по непрерывным массивам без запросов к базе.
+// Объём ограничен по памяти, давно не запрошенные пользователи вытесняются.
+//
+// Читатель получает неизменяемый снимок; запись меняет массивы на месте,
+// если снимок никто не держит, иначе сначала копирует их.
+//
+// Изменения приходят после COMMIT и могут обогнать друг друга, поэтому
+// каждое несёт номер writeStamp(), взятый внутри транзакции. Применяются
+// только изменения новее снимка и всех уже применённых; иначе снимок
+// пользователя сбрасывается и при следующем обращении читается заново.
+class MoodColumnsCache
+{
+public:
+    struct Config {
+        qsizetype maxBytes = 64 * 1024 * 1024;   // 0 — кэш выключен
+    };
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        qsizetype bytes = 0;
+        qsizetype maxBytes = 0;
+        qsizetype users = 0;
+    };
+
+    static MoodColumnsCache &instance();
+
+    // PSQLSERVER_MOOD_CACHE_MB=<n>
+    static Config configFromEnvironment();
+    void configure(const Config &config);
+    bool isEnabled() const;
+
+    // Вся история пользователя; nullptr — ошибка загрузки.
+    // При выключенном кэше история читается из базы при каждом вызове.
+    std::shared_ptr<const MoodColumns> columns(const QString &login);
+
+    // Берётся в транзакции записи после EntriesDatabase::lockDailyMoodStats():
+    // блокировка упорядочивает транзакции пользователя, и номера растут в
+    // порядке их коммитов.
+    quint64 writeStamp();
+
+    void entrySaved(const QString &login, quint64 stamp, int entryId, const QDate &date, const QTime &time,
+                    int mood, const QList<int> &activities, const QList<int> &emotions);
+    void entryUpdated(const QString &login, quint64 stamp, int entryId, const QDate &date, const QTime &time,
+                      int mood, const QList<int> &activities, const QList<int> &emotions);
+    void entryRemoved(const QString &login, quint64 stamp, int entryId);
+    // Изменения, которые нельзя применить на месте (удалены тег, папка, пользователь)
+    void invalidateUser(const QString &login);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<MoodColumns> columns;
+        quint64 stamp = 0;      // номер на начало загрузки или последнего применённого изменения
+    };
+
+    // Загрузки пользователя, идущие прямо сейчас; запись, пришедшая за время
+    // загрузки, не даёт положить её результат в кэш
+    struct Loads {
+        int pending = 0;
+        quint64 writes = 0;
+    };
+
+    MoodColumnsCache();
+    Q_DISABLE_COPY(MoodColumnsCache)
+
+    // Снимок пользователя, готовый к изменению с номером stamp; nullptr —
+    // пользователь не загружен или изменение опоздало и снимок сброшен
+    MoodColumns *mutableColumns(const QString &login, quint64 stamp);
+    void updateCost(const QString &login);
+    void noteWrite(const QString &login);
+
+    mutable QMutex m_mutex;
+    QCache<QString, Entry> m_users;
+    QHash<QString, Loads> m_loads;      // только пользователи с незавершённой загрузкой
+    quint64 m_clock = 0;                // источник writeStamp() и номеров загрузок
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+};
+
+#endif // MOODCOLUMNSCACHE_H
@@ -0,0 +1,50 @@
+#include "RequestExecutor.h"
+
+#include <QThread>
+
+RequestExecutor::RequestExecutor(const Config &config)
+    : m_config(config)
+{
+    m_pool.setMaxThreadCount(qMax(1, m_config.workerThreads));
+    m_pool.setExpiryTimeout(m_config.expiryTimeoutMs);
+
+    if (m_config.mode == Mode::Threaded)
+        qInfo() << "Request executor: threaded, workers:" << m_pool.maxThreadCount();
+    else
+        qInfo() << "Request executor: synchronous";
+}
+
+RequestExecutor::~RequestExecutor()
+{
+    m_pool.waitForDone();
+}
+
+RequestExecutor::Config RequestExecutor::configFromEnvironment()
+{
+    Config config;
+
+    const QString mode = qEnvironmentVariable("PSQLSERVER_EXECUTION_MODE").trimmed().toLower();
+    if (mode == "sync" || mode == "synchronous")
+        config.mode = Mode::Synchronous;
+
+    bool ok = false;
+    const int workers = qEnvironmentVariableIntValue("PSQLSERVER_WORKER_THREADS", &ok);
+    config.workerThreads = (ok && workers > 0) ? workers : qMax(2, QThread::idealThreadCount());
+    config.compression = ResponseCompression::configFromEnvironment();
+
+    return config;
+}
+
+QByteArray RequestExecutor::methodName(QHttpServerRequest::Method method)
+{
+    switch (method) {
+    case QHttpServerRequest::Method::Get:     return "GET";
+    case QHttpServerRequest::Method::Post:    return "POST";
+    case QHttpServerRequest::Method::Put:     return "PUT";
+    case QHttpServerRequest::Method::Delete:  return "DELETE";
+    case QHttpServerRequest::Method::Patch:   return "PATCH";
+    case QHttpServerRequest::Method::Head:    return "HEAD";
+    case QHttpServerRequest::Method::Options: return "OPTIONS";
+    default:                                  return "OTHER";
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef REQUESTEXECUTOR_H
+#define REQUESTEXECUTOR_H
+
+#include <QHttpServer>
+#include <QHttpServerRequest>
+#include <QHttpServerResponse>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QElapsedTimer>
+#include <QDebug>
+#include "Metrics.h"
+#include "Trace.h"
+#include "ResponseCompression.h"
+
+// Выполняет обработчики маршрутов QHttpServer.
+// В режиме Threaded обработчик уходит в собственный пул рабочих потоков,
+// и медленный запрос не задерживает остальные в цикле событий.
+// Каждый рабочий поток берёт своё соединение из ConnectionPool.
+class RequestExecutor
+{
+public:
+    enum class Mode {
+        Synchronous,
+        Threaded
+    };
+
+    struct Config {
+        Mode mode = Mode::Threaded;
+        int workerThreads = 4;
+        int expiryTimeoutMs = 5 * 60 * 1000;  // простаивающий поток завершается и закрывает своё соединение
+        ResponseCompression::Config compression;
+    };
+
+    explicit RequestExecutor(const Config &config);
+    ~RequestExecutor();
+
+    // PSQLSERVER_EXECUTION_MODE=sync|threaded, PSQLSERVER_WORKER_THREADS=<n>,
+    // настройки сжатия — см. ResponseCompression::configFromEnvironment()
+    static Config configFromEnvironment();
+
+    Config config() const { return m_config; }
+
+    // Регистрирует маршрут и считает для него запросы, коды ответов,
+    // объём тел и время до готового ответа (вместе с ожиданием в очереди).
+    // При включённой трассировке запрос получает id, а ожидание рабочего
+    // потока и сам обработчик попадают в трассу отдельными спанами.
+    // Ответ сжимается в рабочем потоке, если клиент это поддерживает.
+    template <typename Handler>
+    void route(QHttpServer &server, const QString &path, QHttpServerRequest::Method method, Handler handler)
+    {
+        RouteMetrics *metrics = Metrics::instance().route(path, methodName(method));
+
+        server.route(path, method, [this, metrics, handler](const QHttpServerRequest &request) -> QFuture<QHttpServerResponse> {
+            const ResponseCompression::Config compression = m_config.compression;
+            QElapsedTimer timer;
+            timer.start();
+            const quint64 requestId = Trace::isEnabled() ? Trace::nextRequestId() : 0;
+            const qint64 queuedNs = requestId ? Trace::nowNs() : 0;
+
+            return execute(request, [metrics, handler, compression, timer, requestId, queuedNs](const QHttpServerRequest &request) {
+                TraceRequestScope traceScope(requestId);
+                if (requestId)
+                    Trace::record("queue", queuedNs, Trace::nowNs(), requestId);
+
+                QHttpServerResponse response = [&] {
+                    TraceSpan span(requestId ? metrics->path.constData() : nullptr);
+                    return ResponseCompression::apply(compression, request, handler(request));
+                }();
+                metrics->record(request.body().size(), int(response.statusCode()),
+                                response.data().size(), timer.nsecsElapsed());
+                return response;
+            });
+        });
+    }
+
+private:
+    static QByteArray methodName(QHttpServerRequest::Method method);
+
+    template <typename Handler>
+    QFuture<QHttpServerResponse> execute(const QHttpServerRequest &request, const Handler &handler)
+    {
+        if (m_config.mode == Mode::Synchronous)
+            return QtFuture::makeReadyValueFuture(handler(request));
+
+        return QtConcurrent::run(&m_pool, [handler, request]() {
+            return handler(request);
+        });
+    }
+
+    Config m_config;
+    QThreadPool m_pool;
+};
+
+#endif // REQUESTEXECUTOR_H
@@ -0,0 +1,175 @@
+#include "ResponseCompression.h"
+#include "Trace.h"
+
+#include <QHttpHeaders>
+#include <QList>
+#include <zlib.h>
+#ifdef PSQLSERVER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+QByteArray deflateData(const QByteArray &data, int windowBits, int level, bool *ok)
+{
+    *ok = false;
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return QByteArray();
+
+    QByteArray out;
+    out.resize(qsizetype(deflateBound(&stream, uLong(data.size()))));
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = uInt(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(out.data());
+    stream.avail_out = uInt(out.size());
+
+    const int result = deflate(&stream, Z_FINISH);
+    const qsizetype written = qsizetype(stream.total_out);
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END)
+        return QByteArray();
+
+    out.resize(written);
+    *ok = true;
+    return out;
+}
+
+int preference(ResponseCompression::Encoding encoding)
+{
+    switch (encoding) {
+    case ResponseCompression::Encoding::Zstd:    return 3;
+    case ResponseCompression::Encoding::Gzip:    return 2;
+    case ResponseCompression::Encoding::Deflate: return 1;
+    default:                                     return 0;
+    }
+}
+
+} // namespace
+
+ResponseCompression::Config ResponseCompression::configFromEnvironment()
+{
+    Config config;
+
+    const QString mode = qEnvironmentVariable("PSQLSERVER_COMPRESSION").trimmed().toLower();
+    if (mode == "off" || mode == "0" || mode == "false")
+        config.enabled = false;
+
+    bool ok = false;
+    const int minBytes = qEnvironmentVariableIntValue("PSQLSERVER_COMPRESSION_MIN_BYTES", &ok);
+    if (ok && minBytes >= 0)
+        config.minBytes = minBytes;
+
+    const int level = qEnvironmentVariableIntValue("PSQLSERVER_COMPRESSION_LEVEL", &ok);
+    if (ok && level > 0)
+        config.level = level;
+
+    return config;
+}
+
+QHttpServerResponse ResponseCompression::apply(const Config &config, const QHttpServerRequest &request, QHttpServerResponse &&response)
+{
+    if (!config.enabled || response.data().size() < config.minBytes)
+        return std::move(response);
+    if (!response.mimeType().startsWith("application/json"))
+        return std::move(response);
+
+    QHttpHeaders headers = response.headers();
+    if (headers.contains(QHttpHeaders::WellKnownHeader::ContentEncoding))
+        return std::move(response);
+
+    const Encoding encoding = negotiate(request.headers().value(QHttpHeaders::WellKnownHeader::AcceptEncoding));
+    if (encoding == Encoding::Identity)
+        return std::move(response);
+
+    bool ok = false;
+    QByteArray compressed;
+    {
+        TRACE_SPAN("compress");
+        compressed = compress(response.data(), encoding, config.level, &ok);
+    }
+    if (!ok || compressed.size() >= response.data().size())
+        return std::move(response);
+
+    QHttpServerResponse result(response.mimeType(), compressed, response.statusCode());
+    headers.replaceOrAppend(QHttpHeaders::WellKnownHeader::ContentEncoding, name(encoding));
+    headers.append(QHttpHeaders::WellKnownHeader::Vary, "Accept-Encoding");
+    result.setHeaders(std::move(headers));
+    return result;
+}
+
+ResponseCompression::Encoding ResponseCompression::negotiate(QByteArrayView acceptEncoding)
+{
+    Encoding best = Encoding::Identity;
+    double bestQuality = 0;
+
+    const QList<QByteArray> items = acceptEncoding.toByteArray().split(',');
+    for (const QByteArray &item : items) {
+        const QList<QByteArray> parts = item.split(';');
+        const QByteArray coding = parts.first().trimmed().toLower();
+
+        double quality = 1.0;
+        for (qsizetype i = 1; i < parts.size(); ++i) {
+            const QByteArray parameter = parts[i].trimmed();
+            if (parameter.startsWith("q="))
+                quality = parameter.mid(2).toDouble();
+        }
+        if (quality <= 0)
+            continue;
+
+        Encoding encoding;
+        if (coding == "gzip" || coding == "x-gzip")
+            encoding = Encoding::Gzip;
+        else if (coding == "deflate")
+            encoding = Encoding::Deflate;
+#ifdef PSQLSERVER_HAVE_ZSTD
+        else if (coding == "zstd")
+            encoding = Encoding::Zstd;
+#endif
+        else
+            continue;
+
+        // при равных q предпочтение: zstd, gzip, deflate
+        if (quality > bestQuality || (quality == bestQuality && preference(encoding) > preference(best))) {
+            best = encoding;
+            bestQuality = quality;
+        }
+    }
+    return best;
+}
+
+QByteArray ResponseCompression::compress(const QByteArray &data, Encoding encoding, int level, bool *ok)
+{
+    switch (encoding) {
+    case Encoding::Gzip:
+        return deflateData(data, 15 + 16, qBound(1, level, 9), ok);   // +16 — gzip-обёртка
+    case Encoding::Deflate:
+        return deflateData(data, 15, qBound(1, level, 9), ok);        // "deflate" в HTTP — формат zlib
+#ifdef PSQLSERVER_HAVE_ZSTD
+    case Encoding::Zstd: {
+        QByteArray out;
+        out.resize(qsizetype(ZSTD_compressBound(size_t(data.size()))));
+        const size_t written = ZSTD_compress(out.data(), size_t(out.size()), data.constData(), size_t(data.size()), level);
+        *ok = !ZSTD_isError(written);
+        out.resize(*ok ? qsizetype(written) : 0);
+        return out;
+    }
+#endif
+    default:
+        *ok = false;
+        return QByteArray();
+    }
+}
+
+QByteArray ResponseCompression::name(Encoding encoding)
+{
+    switch (encoding) {
+    case Encoding::Gzip:    return "gzip";
+    case Encoding::Deflate: return "deflate";
+    case Encoding::Zstd:    return "zstd";
+    default:                return "identity";
+    }
+}
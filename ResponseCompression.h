@@ -0,0 +1,39 @@
+#ifndef RESPONSECOMPRESSION_H
+#define RESPONSECOMPRESSION_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHttpServerRequest>
+#include <QHttpServerResponse>
+
+// Сжатие тел ответов по Accept-Encoding клиента.
+// Сжимаются только JSON-ответы не меньше порога: на коротких ответах
+// заголовки и время на сжатие съедают весь выигрыш.
+class ResponseCompression
+{
+public:
+    enum class Encoding {
+        Identity,
+        Gzip,
+        Deflate,
+        Zstd
+    };
+
+    struct Config {
+        bool enabled = true;
+        int minBytes = 1024;
+        int level = 1;          // быстрый уровень: ответ строится на каждый запрос, задержка важнее степени сжатия
+    };
+
+    // PSQLSERVER_COMPRESSION=off, PSQLSERVER_COMPRESSION_MIN_BYTES=<n>, PSQLSERVER_COMPRESSION_LEVEL=<n>
+    static Config configFromEnvironment();
+
+    static QHttpServerResponse apply(const Config &config, const QHttpServerRequest &request, QHttpServerResponse &&response);
+
+    // Лучшая поддерживаемая кодировка из заголовка Accept-Encoding с учётом q-значений
+    static Encoding negotiate(QByteArrayView acceptEncoding);
+    static QByteArray compress(const QByteArray &data, Encoding encoding, int level, bool *ok);
+    static QByteArray name(Encoding encoding);
+};
+
+#endif // RESPONSECOMPRESSION_H
@@ -1,14 +1,16 @@
 // TodoDatabase.cpp
 
 #include "TodoDatabase.h"
+#include "DataVersions.h"
 
 bool TodoDatabase::saveUserTodo(const QString &login, const QString &name)
 {
+    METRICS_QUERY_SCOPE("TodoDatabase::saveUserTodo");
     if (login.isEmpty() || name.isEmpty())
         return false;
 
-    QSqlQuery checkQuery;
-    checkQuery.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &checkQuery = connection.prepared(R"(
         SELECT 1 FROM user_todo
         WHERE user_login = :login AND name = :name
         LIMIT 1
@@ -24,8 +26,7 @@ bool TodoDatabase::saveUserTodo(const QString &login, const QString &name)
         return false;
     }
 
-    QSqlQuery insertQuery;
-    insertQuery.prepare(R"(
+    QSqlQuery &insertQuery = connection.prepared(R"(
         INSERT INTO user_todo (user_login, name)
         VALUES (:login, :name)
     )");
@@ -36,15 +37,17 @@ bool TodoDatabase::saveUserTodo(const QString &login, const QString &name)
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Todos);
     return true;
 }
 
 QStringList TodoDatabase::getUserTodoos(const QString &login)
 {
+    METRICS_QUERY_SCOPE("TodoDatabase::getUserTodoos");
     QStringList todos;
 
-    QSqlQuery query;
-    query.prepare(R"(
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         SELECT name FROM user_todo
         WHERE user_login = :login
         ORDER BY id ASC
@@ -64,8 +67,9 @@ QStringList TodoDatabase::getUserTodoos(const QString &login)
 
 bool TodoDatabase::deleteTodo(const QString &login, const QString &name)
 {
-    QSqlQuery query;
-    query.prepare(R"(
+    METRICS_QUERY_SCOPE("TodoDatabase::deleteTodo");
+    PooledConnection connection;
+    QSqlQuery &query = connection.prepared(R"(
         DELETE FROM user_todo
         WHERE user_login = :login AND name = :name
     )");
@@ -76,5 +80,6 @@ bool TodoDatabase::deleteTodo(const QString &login, const QString &name)
         return false;
     }
 
+    DataVersions::bump(login, DataVersions::Collection::Todos);
     return true;
 }
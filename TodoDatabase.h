@@ -6,6 +6,8 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
+#include "ConnectionPool.h"
+#include "Metrics.h"
 
 class TodoDatabase
 {
@@ -1,5 +1,6 @@
 #include "TodoDatabase.h"
 #include "TodoManager.h"
+#include "DataVersions.h"
 
 TodoManager::TodoManager(QObject *parent)
     : QObject(parent)
@@ -56,6 +57,10 @@ QHttpServerResponse TodoManager::handleGetUserTodoos(const QHttpServerRequest &r
         return QHttpServerResponse("Missing login", QHttpServerResponse::StatusCode::BadRequest);
     }
 
+    const QByteArray etag = DataVersions::etag(login, DataVersions::Collection::Todos);
+    if (DataVersions::isNotModified(request, etag))
+        return DataVersions::notModified(etag);
+
     QStringList todoos = TodoDatabase::getUserTodoos(login);
     qDebug() << "Список задач полученный из базы данных:" << todoos;
 
@@ -71,7 +76,9 @@ QHttpServerResponse TodoManager::handleGetUserTodoos(const QHttpServerRequest &r
     }
     qDebug() << "Готовый к отправке клиенту список задач:" << todoosArray;
     response["todoos"] = todoosArray;
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    QHttpServerResponse httpResponse("application/json", QJsonDocument(response).toJson());
+    DataVersions::setETag(httpResponse, etag);
+    return httpResponse;
 }
 
 QHttpServerResponse TodoManager::handleDeleteTodo(const QHttpServerRequest &request)
@@ -0,0 +1,206 @@
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char *name = nullptr;
+    quint64 requestId = 0;
+    qint64 startNs = 0;
+    qint64 endNs = 0;
+};
+
+// Буфер одного потока. Пишет в него только владелец; мьютекс нужен лишь
+// для того, чтобы dump() не прочитал наполовину записанное событие, и
+// без dump() он всегда свободен.
+struct ThreadBuffer {
+    static constexpr std::size_t Capacity = 4096;
+
+    QMutex mutex;
+    std::array<TraceEvent, Capacity> events;
+    quint64 written = 0;
+    int threadId = 0;
+};
+
+// Буфер завершившегося потока держит только реестр: его события ещё можно
+// выгрузить. Рабочие потоки завершаются после простоя и создаются заново,
+// поэтому такие буферы удаляются после dump() и clear(), а до тех пор их
+// хранится не больше MaxDeadBuffers (самые старые удаляются первыми).
+struct Registry {
+    static constexpr std::size_t MaxDeadBuffers = 16;
+
+    QMutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int nextThreadId = 1;
+
+    // Под mutex. Оставляет keep самых новых буферов завершившихся потоков.
+    void pruneDead(std::size_t keep)
+    {
+        std::size_t dead = 0;
+        for (const std::shared_ptr<ThreadBuffer> &buffer : buffers)
+            dead += buffer.use_count() == 1 ? 1 : 0;
+        if (dead <= keep)
+            return;
+
+        std::size_t toRemove = dead - keep;
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [&toRemove](const std::shared_ptr<ThreadBuffer> &buffer) {
+                                         if (toRemove == 0 || buffer.use_count() != 1)
+                                             return false;
+                                         --toRemove;
+                                         return true;
+                                     }),
+                      buffers.end());
+    }
+};
+
+Registry &registry()
+{
+    static Registry *instance = new Registry;
+    return *instance;
+}
+
+ThreadBuffer &localBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        buffer->threadId = reg.nextThreadId++;
+        reg.pruneDead(Registry::MaxDeadBuffers);
+        reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+const QElapsedTimer &clock()
+{
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+thread_local quint64 t_requestId = 0;
+std::atomic<quint64> s_nextRequestId{1};
+
+void appendMicroseconds(QByteArray &out, qint64 nanoseconds)
+{
+    out.append(QByteArray::number(double(nanoseconds) / 1000.0, 'f', 3));
+}
+
+} // namespace
+
+void Trace::setEnabled(bool enabled)
+{
+    clock();
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+quint64 Trace::nextRequestId()
+{
+    return s_nextRequestId.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 Trace::currentRequestId()
+{
+    return t_requestId;
+}
+
+void Trace::setCurrentRequestId(quint64 requestId)
+{
+    t_requestId = requestId;
+}
+
+qint64 Trace::nowNs()
+{
+    return clock().nsecsElapsed();
+}
+
+void Trace::record(const char *name, qint64 startNs, qint64 endNs, quint64 requestId)
+{
+    ThreadBuffer &buffer = localBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    TraceEvent &event = buffer.events[buffer.written % ThreadBuffer::Capacity];
+    event.name = name;
+    event.requestId = requestId;
+    event.startNs = startNs;
+    event.endNs = endNs;
+    ++buffer.written;
+}
+
+QByteArray Trace::dump()
+{
+    Registry &reg = registry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<const ThreadBuffer *> finished;  // потоки уже завершились, новых событий не будет
+    {
+        QMutexLocker locker(&reg.mutex);
+        for (const std::shared_ptr<ThreadBuffer> &buffer : reg.buffers) {
+            if (buffer.use_count() == 1)
+                finished.push_back(buffer.get());
+        }
+        buffers = reg.buffers;
+    }
+
+    QByteArray out;
+    out.reserve(1024 * 1024);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+        QMutexLocker locker(&buffer->mutex);
+        const quint64 count = std::min<quint64>(buffer->written, ThreadBuffer::Capacity);
+        for (quint64 i = buffer->written - count; i < buffer->written; ++i) {
+            const TraceEvent &event = buffer->events[i % ThreadBuffer::Capacity];
+            if (!first)
+                out.append(',');
+            first = false;
+
+            // имена спанов — литералы из кода, экранирование не требуется
+            out.append("{\"name\":\"").append(event.name)
+                .append("\",\"ph\":\"X\",\"pid\":1,\"tid\":").append(QByteArray::number(buffer->threadId))
+                .append(",\"ts\":");
+            appendMicroseconds(out, event.startNs);
+            out.append(",\"dur\":");
+            appendMicroseconds(out, event.endNs - event.startNs);
+            out.append(",\"args\":{\"request\":").append(QByteArray::number(event.requestId)).append("}}");
+        }
+    }
+
+    out.append("]}");
+
+    // события завершившихся потоков выгружены целиком, их буферы больше не нужны
+    buffers.clear();
+    QMutexLocker locker(&reg.mutex);
+    reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+                                     [&finished](const std::shared_ptr<ThreadBuffer> &buffer) {
+                                         return std::find(finished.cbegin(), finished.cend(), buffer.get())
+                                                != finished.cend();
+                                     }),
+                      reg.buffers.end());
+    return out;
+}
+
+void Trace::clear()
+{
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    reg.pruneDead(0);
+    for (const std::shared_ptr<ThreadBuffer> &buffer : reg.buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->written = 0;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <atomic>
+
+// Лёгкая трассировка фаз запроса (очередь, разбор, SQL, сериализация).
+// Спаны пишутся в кольцевой буфер своего потока и выгружаются в формате
+// Chrome trace events (chrome://tracing, Perfetto) через GET /debug/trace.
+// Пока трассировка выключена, TraceSpan стоит одну relaxed-загрузку флага.
+class Trace
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    // Идентификатор запроса, к которому относятся спаны текущего потока.
+    static quint64 nextRequestId();
+    static quint64 currentRequestId();
+    static void setCurrentRequestId(quint64 requestId);
+
+    static qint64 nowNs();
+
+    // name должен жить до конца процесса (строковый литерал).
+    static void record(const char *name, qint64 startNs, qint64 endNs, quint64 requestId);
+
+    static QByteArray dump();
+    static void clear();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(Trace::isEnabled() ? name : nullptr)
+        , m_startNs(m_name ? Trace::nowNs() : 0)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_name)
+            Trace::record(m_name, m_startNs, Trace::nowNs(), Trace::currentRequestId());
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char *m_name;
+    qint64 m_startNs;
+};
+
+// Привязывает спаны рабочего потока к запросу на время обработки.
+class TraceRequestScope
+{
+public:
+    explicit TraceRequestScope(quint64 requestId)
+        : m_previous(Trace::currentRequestId())
+    {
+        Trace::setCurrentRequestId(requestId);
+    }
+
+    ~TraceRequestScope() { Trace::setCurrentRequestId(m_previous); }
+
+private:
+    Q_DISABLE_COPY(TraceRequestScope)
+    quint64 m_previous;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#endif // TRACE_H
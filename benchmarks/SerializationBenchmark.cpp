@@ -0,0 +1,223 @@
+#include "SerializationBenchmark.h"
+
+#include <QtTest>
+#include <QJsonDocument>
+#include "AuthManager.h"
+#include "EntriesManager.h"
+#include "EntryJsonWriter.h"
+
+QString SerializationBenchmark::htmlContent(int bytes, int seed)
+{
+    // Похоже на то, что присылает редактор клиента: абзацы кириллицы с
+    // разметкой, кавычками и переносами, которые приходится экранировать.
+    static const QStringList words = {
+        "сегодня", "работа", "прогулка", "встреча", "день", "настроение", "\"важно\"",
+        "дом", "кофе", "спорт", "книга", "weekend", "вечер", "усталость", "радость"
+    };
+
+    QString html;
+    html.reserve(bytes);
+    int index = seed;
+    while (html.toUtf8().size() < bytes) {
+        html += "<p>";
+        for (int i = 0; i < 24; ++i) {
+            const QString &word = words[(index++ * 7) % words.size()];
+            html += (i % 9 == 4) ? "<b>" + word + "</b>" : word;
+            html += ' ';
+        }
+        html += "</p>\n";
+    }
+    return html;
+}
+
+EntryUser SerializationBenchmark::makeEntry(int id, int contentBytes, int relations)
+{
+    EntryUser entry;
+    entry.id = id;
+    entry.userLogin = "benchuser";
+    entry.title = QString("Запись №%1").arg(id);
+    entry.content = htmlContent(contentBytes, id);
+    entry.moodId = id % 5;
+    entry.folderId = 1;
+    entry.date = QDate(2024, 1, 1).addDays(id);
+    entry.time = QTime(8, 0).addSecs(id * 97);
+    for (int i = 0; i < relations; ++i) {
+        entry.tags.append({ i + 1, 0, QString("тег %1").arg(i) });
+        entry.activities.append({ i + 100, i % 40, QString("активность %1").arg(i) });
+        entry.emotions.append({ i + 200, i % 30, QString("эмоция %1").arg(i) });
+    }
+    return entry;
+}
+
+QJsonObject SerializationBenchmark::entryJson(int contentBytes, int relations)
+{
+    const EntryUser entry = makeEntry(1, contentBytes, relations);
+
+    QJsonArray tags, activities, emotions;
+    for (int i = 0; i < relations; ++i) {
+        tags.append(entry.tags[i].id);
+        activities.append(entry.activities[i].id);
+        emotions.append(entry.emotions[i].id);
+    }
+
+    QJsonObject json;
+    json["login"] = entry.userLogin;
+    json["title"] = entry.title;
+    json["content"] = entry.content;
+    json["moodId"] = entry.moodId;
+    json["folder"] = entry.folderId;
+    json["date"] = entry.date.toString(Qt::ISODate);
+    json["time"] = entry.time.toString("HH:mm");
+    json["tags"] = tags;
+    json["activities"] = activities;
+    json["emotions"] = emotions;
+    return json;
+}
+
+void SerializationBenchmark::addEntryShapes()
+{
+    QTest::addColumn<int>("contentBytes");
+    QTest::addColumn<int>("relations");
+
+    QTest::newRow("short-note") << 300 << 1;
+    QTest::newRow("typical") << 4 * 1024 << 5;
+    QTest::newRow("long-html") << 32 * 1024 << 12;
+}
+
+void SerializationBenchmark::entryFromJson_data()
+{
+    addEntryShapes();
+}
+
+void SerializationBenchmark::entryFromJson()
+{
+    QFETCH(int, contentBytes);
+    QFETCH(int, relations);
+    const QJsonObject json = entryJson(contentBytes, relations);
+
+    QBENCHMARK {
+        const EntryUser entry = EntryUser::fromJson(json);
+        Q_UNUSED(entry);
+    }
+}
+
+void SerializationBenchmark::saveEntryBody_data()
+{
+    addEntryShapes();
+}
+
+void SerializationBenchmark::saveEntryBody()
+{
+    // То же, что делает /saveentry до обращения к базе: разбор тела и полей
+    QFETCH(int, contentBytes);
+    QFETCH(int, relations);
+    const QByteArray body = QJsonDocument(entryJson(contentBytes, relations)).toJson(QJsonDocument::Compact);
+
+    QBENCHMARK {
+        QJsonParseError parseError;
+        const QJsonObject json = QJsonDocument::fromJson(body, &parseError).object();
+        const EntryUser entry = EntryUser::fromJson(json);
+        const QVector<UserItem> tags = EntriesManager::parseUserItemsArray(json.value("tags"));
+        Q_UNUSED(entry);
+        Q_UNUSED(tags);
+    }
+}
+
+void SerializationBenchmark::parseUserItemsArray_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("5") << 5;
+    QTest::newRow("50") << 50;
+    QTest::newRow("500") << 500;
+}
+
+void SerializationBenchmark::parseUserItemsArray()
+{
+    QFETCH(int, count);
+    QJsonArray ids;
+    for (int i = 0; i < count; ++i)
+        ids.append(i + 1);
+    const QJsonValue value(ids);
+
+    QBENCHMARK {
+        const QVector<UserItem> items = EntriesManager::parseUserItemsArray(value);
+        Q_UNUSED(items);
+    }
+}
+
+void SerializationBenchmark::appendEntry_data()
+{
+    addEntryShapes();
+}
+
+void SerializationBenchmark::appendEntry()
+{
+    QFETCH(int, contentBytes);
+    QFETCH(int, relations);
+    const EntryUser entry = makeEntry(1, contentBytes, relations);
+
+    QByteArray out;
+    QBENCHMARK {
+        out.clear();
+        EntryJsonWriter::appendEntry(out, entry);
+    }
+}
+
+void SerializationBenchmark::writeEntries_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("contentBytes");
+    QTest::addColumn<int>("relations");
+
+    QTest::newRow("month-31") << 31 << 2 * 1024 << 4;
+    QTest::newRow("page-200") << 200 << 4 * 1024 << 5;
+    QTest::newRow("search-1000-short") << 1000 << 400 << 2;
+}
+
+void SerializationBenchmark::writeEntries()
+{
+    QFETCH(int, count);
+    QFETCH(int, contentBytes);
+    QFETCH(int, relations);
+
+    QList<EntryUser> entries;
+    entries.reserve(count);
+    for (int i = 0; i < count; ++i)
+        entries.append(makeEntry(i + 1, contentBytes, relations));
+
+    QBENCHMARK {
+        const QByteArray json = EntryJsonWriter::writeEntries(entries, "cursor");
+        Q_UNUSED(json);
+    }
+}
+
+void SerializationBenchmark::appendString_data()
+{
+    QTest::addColumn<QString>("value");
+
+    QTest::newRow("ascii") << QString("plain ascii text without anything to escape ").repeated(64);
+    QTest::newRow("cyrillic-html") << htmlContent(4 * 1024, 3);
+    QTest::newRow("escape-heavy") << QString("\"quoted\"\t\\path\\\n").repeated(128);
+}
+
+void SerializationBenchmark::appendString()
+{
+    QFETCH(QString, value);
+
+    QByteArray out;
+    QBENCHMARK {
+        out.clear();
+        EntryJsonWriter::appendString(out, value);
+    }
+}
+
+void SerializationBenchmark::hashPassword()
+{
+    const QString password = "correct horse battery staple";
+
+    QBENCHMARK {
+        const QString hash = AuthManager::hashPassword(password);
+        Q_UNUSED(hash);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SERIALIZATIONBENCHMARK_H
+#define SERIALIZATIONBENCHMARK_H
+
+#include <QObject>
+#include <QList>
+#include "EntryUser.h"
+
+// Разбор входящих JSON, сериализация ответов и хэширование паролей —
+// всё, что выполняется на каждый запрос и не зависит от базы.
+class SerializationBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void entryFromJson_data();
+    void entryFromJson();
+    void saveEntryBody_data();
+    void saveEntryBody();
+    void parseUserItemsArray_data();
+    void parseUserItemsArray();
+    void appendEntry_data();
+    void appendEntry();
+    void writeEntries_data();
+    void writeEntries();
+    void appendString_data();
+    void appendString();
+    void hashPassword();
+
+private:
+    static QString htmlContent(int bytes, int seed);
+    static EntryUser makeEntry(int id, int contentBytes, int relations);
+    static QJsonObject entryJson(int contentBytes, int relations);
+    static void addEntryShapes();
+};
+
+#endif // SERIALIZATIONBENCHMARK_H
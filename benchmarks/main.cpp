@@ -0,0 +1,124 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QtTest>
+#include <cstdio>
+#include "SerializationBenchmark.h"
+
+// Запуск: psqlserver-bench [--results <csv>] [--baseline <csv>] [--save-baseline]
+//         [--tolerance <процент>] [параметры QTest, например -iterations 50]
+// Результаты пишутся в CSV (формат QTest: функция, тег, метрика, значение на
+// итерацию, сумма, итерации) и сравниваются с сохранённой базой. Код возврата 1,
+// если хоть один замер медленнее базы больше чем на tolerance процентов или
+// базы нет: сравнивать не с чем, и молча пройти такую проверку нельзя.
+//
+// База зависит от машины и в репозитории не хранится. Чтобы создать или
+// обновить её, запустите Release-сборку на эталонной машине с --save-baseline
+// (файл по умолчанию — PSQLSERVER_BENCHMARK_BASELINE из CMake, в каталоге сборки).
+
+namespace {
+
+struct Measurement {
+    QString metric;
+    double value = 0;
+};
+
+QMap<QString, Measurement> readResults(const QString &fileName)
+{
+    QMap<QString, Measurement> results;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return results;
+
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        const QStringList fields = line.split(',');
+        if (fields.size() < 4)
+            continue;
+
+        auto unquote = [](QString field) { return field.remove('"'); };
+        Measurement measurement;
+        measurement.metric = unquote(fields[2]);
+        bool ok = false;
+        measurement.value = fields[3].toDouble(&ok);
+        if (ok)
+            results.insert(unquote(fields[0]) + '/' + unquote(fields[1]), measurement);
+    }
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QString resultsFile = "benchmark-results.csv";
+    QString baselineFile = PSQLSERVER_BENCHMARK_BASELINE;
+    bool saveBaseline = false;
+    double tolerance = 10.0;
+
+    QStringList testArguments = { app.arguments().first() };
+    const QStringList arguments = app.arguments();
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &argument = arguments[i];
+        if (argument == "--results" && i + 1 < arguments.size())
+            resultsFile = arguments[++i];
+        else if (argument == "--baseline" && i + 1 < arguments.size())
+            baselineFile = arguments[++i];
+        else if (argument == "--tolerance" && i + 1 < arguments.size())
+            tolerance = arguments[++i].toDouble();
+        else if (argument == "--save-baseline")
+            saveBaseline = true;
+        else
+            testArguments << argument;
+    }
+    testArguments << "-o" << resultsFile + ",csv" << "-o" << "-,txt";
+
+    SerializationBenchmark benchmark;
+    const int failures = QTest::qExec(&benchmark, testArguments);
+    if (failures != 0)
+        return failures;
+
+    if (saveBaseline) {
+        QFile::remove(baselineFile);
+        if (!QFile::copy(resultsFile, baselineFile)) {
+            std::fprintf(stderr, "Cannot save baseline to %s\n", qPrintable(baselineFile));
+            return 1;
+        }
+        std::printf("Baseline saved to %s\n", qPrintable(baselineFile));
+        return 0;
+    }
+
+    const QMap<QString, Measurement> baseline = readResults(baselineFile);
+    if (baseline.isEmpty()) {
+        std::fprintf(stderr, "No baseline at %s, run with --save-baseline to create one.\n",
+                     qPrintable(baselineFile));
+        return 1;
+    }
+
+    int regressions = 0;
+    const QMap<QString, Measurement> current = readResults(resultsFile);
+    std::printf("\n%-60s %14s %14s %9s\n", "benchmark", "baseline", "current", "change");
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        const auto base = baseline.constFind(it.key());
+        if (base == baseline.constEnd() || base->metric != it->metric || base->value <= 0) {
+            std::printf("%-60s %14s %14.6g %9s\n", qPrintable(it.key()), "-", it->value, "new");
+            continue;
+        }
+
+        const double change = (it->value - base->value) / base->value * 100.0;
+        const bool regressed = change > tolerance;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-60s %14.6g %14.6g %+8.1f%%%s\n", qPrintable(it.key()), base->value, it->value, change,
+                    regressed ? "  REGRESSION" : "");
+    }
+
+    if (regressions > 0) {
+        std::printf("%d benchmark(s) slower than baseline by more than %.1f%%\n", regressions, tolerance);
+        return 1;
+    }
+    return 0;
+}
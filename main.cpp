@@ -1,11 +1,17 @@
 #include "main.h"
 #include "EntriesManager.h"
-#include "database.h"
+#include "Database.h"
 #include "TodoManager.h"
 #include "AuthManager.h"
 #include "FoldersManager.h"
 #include "CategoriesManager.h"
 #include "ComputeManager.h"
+#include "RequestExecutor.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "EntryPageCache.h"
+#include "MoodColumnsCache.h"
+#include "Logger.h"
 
 void startServer(QHttpServer &server)
 {
@@ -25,18 +31,46 @@ void startServer(QHttpServer &server)
     tcpserver.release();  // управление передано QHttpServer
 }
 
+// Служебные маршруты (/metrics, /debug/trace) показывают трафик по маршрутам,
+// размеры пула и кэшей, ход запросов, а трассировку ещё и включают, поэтому
+// по умолчанию отвечают только локальным клиентам.
+// PSQLSERVER_PUBLIC_DIAGNOSTICS=1 открывает их для всех, например для Prometheus
+// на другой машине.
+bool isDiagnosticsAllowed(const QHttpServerRequest &request)
+{
+    static const bool allowRemote = qEnvironmentVariableIntValue("PSQLSERVER_PUBLIC_DIAGNOSTICS") != 0;
+    return allowRemote || request.remoteAddress().isLoopback();
+}
+
 int main(int argc, char** argv)
 {
     QCoreApplication app(argc, argv);
 
-    if (!Database::connect()) {
+    // создаётся сразу после приложения и разрушается последним: сообщения из деструкторов
+    // остальных объектов main() тоже успевают записаться
+    Logger logger(Logger::configFromEnvironment());
+
+    const RequestExecutor::Config executorConfig = RequestExecutor::configFromEnvironment();
+
+    // каждому рабочему потоку и главному потоку нужно своё соединение
+    if (!Database::connect(executorConfig.workerThreads + 1)) {
         qCritical() << "Database connection failed.";
         return -1;
     }
 
     qInfo() << "Database connected successfully.";
 
-    QHttpServer server;
+    if (!Database::ensureSchema()) {
+        qWarning() << "Database schema is not up to date, some features may fail.";
+    }
+
+    // PSQLSERVER_TRACE=1 включает трассировку с самого старта;
+    // во время работы её переключает GET /debug/trace?enable=1|0
+    Trace::setEnabled(qEnvironmentVariableIntValue("PSQLSERVER_TRACE") != 0);
+
+    EntryPageCache::instance().configure(EntryPageCache::configFromEnvironment());
+    MoodColumnsCache::instance().configure(MoodColumnsCache::configFromEnvironment());
+
     TodoManager todoManager;
     AuthManager authManager;
     FoldersManager foldersManager;
@@ -44,139 +78,175 @@ int main(int argc, char** argv)
     EntriesManager entriesManager;
     ComputeManager computeManager;
 
-    server.route("/register", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handleRegister(request);
-                 });
-    server.route("/login", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handleLogin(request);
-                 });
-    server.route("/changepassword", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handlePasswordChange(request);
-                 });
-    server.route("/recoverpassword", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handlePasswordRecover(request);
-                 });
-    server.route("/deleteuser", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handleLoginToDelete(request);
-                 });
-    server.route("/changemail", QHttpServerRequest::Method::Post,
-                 [&authManager](const QHttpServerRequest &request) {
-                     return authManager.handleEmailChange(request);
-                 });
-
-
-    server.route("/savetags", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleSaveTags(request);
-                 });
-    server.route("/getusertags", QHttpServerRequest::Method::Get,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleGetUserTags(request);
-                 });
-    server.route("/deletetag", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleDeleteTag(request);
-                 });
-
-
-    server.route("/saveactivity", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleSaveActivity(request);
-                 });
-    server.route("/getuseractivity", QHttpServerRequest::Method::Get,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleGetUserActivity(request);
-                 });
-    server.route("/deleteactivity", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleDeleteActivity(request);
-                 });
-
-    server.route("/saveemotion", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleSaveEmotion(request);
-                 });
-    server.route("/getuseremotions", QHttpServerRequest::Method::Get,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleGetUserEmotions(request);
-                 });
-    server.route("/deleteemotion", QHttpServerRequest::Method::Post,
-                 [&categoriesManager](const QHttpServerRequest &request) {
-                     return categoriesManager.handleDeleteEmotion(request);
-                 });
-
-    server.route("/savefolder", QHttpServerRequest::Method::Post,
-                 [&foldersManager](const QHttpServerRequest &request) {
-                     return foldersManager.handleSaveFolder(request);
-                 });
-    server.route("/getuserfolders", QHttpServerRequest::Method::Get,
-                 [&foldersManager](const QHttpServerRequest &request) {
-                     return foldersManager.handleGetUserFolders(request);
-                 });
-    server.route("/deletefolder", QHttpServerRequest::Method::Post,
-                 [&foldersManager](const QHttpServerRequest &request) {
-                     return foldersManager.handleDeleteFolder(request);
-                 });
-    server.route("/changefolder", QHttpServerRequest::Method::Post,
-                 [&foldersManager](const QHttpServerRequest &request) {
-                     return foldersManager.handleFolderChange(request);
-                 });
-
-    server.route("/savetodo", QHttpServerRequest::Method::Post,
-                 [&todoManager](const QHttpServerRequest &request) {
-                     return todoManager.handleSaveTodo(request);
-                 });
-    server.route("/getusertodoos", QHttpServerRequest::Method::Get,
-                 [&todoManager](const QHttpServerRequest &request) {
-                     return todoManager.handleGetUserTodoos(request);
-                 });
-    server.route("/deletetodo", QHttpServerRequest::Method::Post,
-                 [&todoManager](const QHttpServerRequest &request) {
-                     return todoManager.handleDeleteTodo(request);
-                 });
-
-    server.route("/saveentry", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleSaveEntry(request);
-                 });
-    server.route("/getuserentries", QHttpServerRequest::Method::Get,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleGetUserEntries(request);
-                 });
-    server.route("/searchentriesbywords", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleSearchEntriesByKeywords(request);
-                 });
-    server.route("/searchentriesbytags", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleSearchEntriesByTags(request);
-                 });
-    server.route("/searchentriesbydate", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleSearchEntriesByDate(request);
-                 });
-    server.route("/getmoodidies", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleSearchEntriesMoodIdies(request);
-                 });
-    server.route("/deleteentry", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleDeleteEntry(request);
-                 });
-    server.route("/updateentry", QHttpServerRequest::Method::Post,
-                 [&entriesManager](const QHttpServerRequest &request) {
-                     return entriesManager.handleUpdateEntry(request);
-                 });
-
-    server.route("/loadentriesbymonth", QHttpServerRequest::Method::Post,
-                 [&computeManager](const QHttpServerRequest &request) {
-                     return computeManager.handleLoadEntriesByMonth(request);
-                 });
+    // executor объявлен после менеджеров и до сервера: при выходе он
+    // дожидается запущенных обработчиков, пока менеджеры ещё живы
+    RequestExecutor executor(executorConfig);
+    QHttpServer server;
+
+    executor.route(server, "/register", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handleRegister(request);
+                   });
+    executor.route(server, "/login", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handleLogin(request);
+                   });
+    executor.route(server, "/changepassword", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handlePasswordChange(request);
+                   });
+    executor.route(server, "/recoverpassword", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handlePasswordRecover(request);
+                   });
+    executor.route(server, "/deleteuser", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handleLoginToDelete(request);
+                   });
+    executor.route(server, "/changemail", QHttpServerRequest::Method::Post,
+                   [&authManager](const QHttpServerRequest &request) {
+                       return authManager.handleEmailChange(request);
+                   });
+
+
+    executor.route(server, "/savetags", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleSaveTags(request);
+                   });
+    executor.route(server, "/getusertags", QHttpServerRequest::Method::Get,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleGetUserTags(request);
+                   });
+    executor.route(server, "/deletetag", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleDeleteTag(request);
+                   });
+
+
+    executor.route(server, "/saveactivity", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleSaveActivity(request);
+                   });
+    executor.route(server, "/getuseractivity", QHttpServerRequest::Method::Get,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleGetUserActivity(request);
+                   });
+    executor.route(server, "/deleteactivity", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleDeleteActivity(request);
+                   });
+
+    executor.route(server, "/saveemotion", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleSaveEmotion(request);
+                   });
+    executor.route(server, "/getuseremotions", QHttpServerRequest::Method::Get,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleGetUserEmotions(request);
+                   });
+    executor.route(server, "/deleteemotion", QHttpServerRequest::Method::Post,
+                   [&categoriesManager](const QHttpServerRequest &request) {
+                       return categoriesManager.handleDeleteEmotion(request);
+                   });
+
+    executor.route(server, "/savefolder", QHttpServerRequest::Method::Post,
+                   [&foldersManager](const QHttpServerRequest &request) {
+                       return foldersManager.handleSaveFolder(request);
+                   });
+    executor.route(server, "/getuserfolders", QHttpServerRequest::Method::Get,
+                   [&foldersManager](const QHttpServerRequest &request) {
+                       return foldersManager.handleGetUserFolders(request);
+                   });
+    executor.route(server, "/deletefolder", QHttpServerRequest::Method::Post,
+                   [&foldersManager](const QHttpServerRequest &request) {
+                       return foldersManager.handleDeleteFolder(request);
+                   });
+    executor.route(server, "/changefolder", QHttpServerRequest::Method::Post,
+                   [&foldersManager](const QHttpServerRequest &request) {
+                       return foldersManager.handleFolderChange(request);
+                   });
+
+    executor.route(server, "/savetodo", QHttpServerRequest::Method::Post,
+                   [&todoManager](const QHttpServerRequest &request) {
+                       return todoManager.handleSaveTodo(request);
+                   });
+    executor.route(server, "/getusertodoos", QHttpServerRequest::Method::Get,
+                   [&todoManager](const QHttpServerRequest &request) {
+                       return todoManager.handleGetUserTodoos(request);
+                   });
+    executor.route(server, "/deletetodo", QHttpServerRequest::Method::Post,
+                   [&todoManager](const QHttpServerRequest &request) {
+                       return todoManager.handleDeleteTodo(request);
+                   });
+
+    executor.route(server, "/saveentry", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleSaveEntry(request);
+                   });
+    executor.route(server, "/getuserentries", QHttpServerRequest::Method::Get,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleGetUserEntries(request);
+                   });
+    executor.route(server, "/searchentriesbywords", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleSearchEntriesByKeywords(request);
+                   });
+    executor.route(server, "/searchentriesbytags", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleSearchEntriesByTags(request);
+                   });
+    executor.route(server, "/searchentriesbydate", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleSearchEntriesByDate(request);
+                   });
+    executor.route(server, "/getmoodidies", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleSearchEntriesMoodIdies(request);
+                   });
+    executor.route(server, "/getmoodidiesbyrange", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleGetMoodIdiesByRange(request);
+                   });
+    executor.route(server, "/deleteentry", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleDeleteEntry(request);
+                   });
+    executor.route(server, "/updateentry", QHttpServerRequest::Method::Post,
+                   [&entriesManager](const QHttpServerRequest &request) {
+                       return entriesManager.handleUpdateEntry(request);
+                   });
+
+    executor.route(server, "/loadentriesbymonth", QHttpServerRequest::Method::Post,
+                   [&computeManager](const QHttpServerRequest &request) {
+                       return computeManager.handleLoadEntriesByMonth(request);
+                   });
+    executor.route(server, "/computestats", QHttpServerRequest::Method::Post,
+                   [&computeManager](const QHttpServerRequest &request) {
+                       return computeManager.handleComputeStats(request);
+                   });
+    executor.route(server, "/computecorrelations", QHttpServerRequest::Method::Post,
+                   [&computeManager](const QHttpServerRequest &request) {
+                       return computeManager.handleComputeCorrelations(request);
+                   });
+
+    server.route("/metrics", QHttpServerRequest::Method::Get, [](const QHttpServerRequest &request) {
+        if (!isDiagnosticsAllowed(request))
+            return QHttpServerResponse(QHttpServerResponder::StatusCode::Forbidden);
+        return QHttpServerResponse("text/plain; version=0.0.4", Metrics::instance().render());
+    });
+
+    server.route("/debug/trace", QHttpServerRequest::Method::Get, [](const QHttpServerRequest &request) {
+        if (!isDiagnosticsAllowed(request))
+            return QHttpServerResponse(QHttpServerResponder::StatusCode::Forbidden);
+        const QUrlQuery query(request.url());
+        if (query.hasQueryItem("enable"))
+            Trace::setEnabled(query.queryItemValue("enable") != "0");
+        if (query.hasQueryItem("clear")) {
+            Trace::clear();
+            return QHttpServerResponse(QHttpServerResponder::StatusCode::NoContent);
+        }
+        return QHttpServerResponse("application/json", Trace::dump());
+    });
 
     startServer(server);
 
@@ -2,6 +2,7 @@
 #include <QHttpServer>
 #include <QTcpServer>
 #include <QLoggingCategory>
+#include <QUrlQuery>
 #include <QDebug>
 #include <QDebug>
 #include <cstdio>
@@ -10,5 +11,6 @@
 #define MAIN_H
 
 void startServer();
+bool isDiagnosticsAllowed(const QHttpServerRequest &request);
 
 #endif // MAIN_H
@@ -0,0 +1,157 @@
+#include "ComputeStatsTest.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtTest>
+
+namespace {
+
+const QDate From(2024, 3, 4);   // понедельник
+const QDate To(2024, 3, 10);    // воскресенье
+
+} // namespace
+
+// Неделя [From; To] и записи вокруг неё: 20.02 попадает только в окно
+// rolling30, 28.02 и 03.03 — в предыдущий период, 11.03 — уже после To.
+MoodColumns ComputeStatsTest::sample()
+{
+    MoodColumns columns;
+    int id = 0;
+    auto add = [&](const QDate &date, int mood) { columns.append(++id, date, QTime(12, 0), mood, {}, {}); };
+    add(QDate(2024, 2, 20), 4);
+    add(QDate(2024, 2, 28), 2);
+    add(QDate(2024, 2, 28), 3);
+    add(QDate(2024, 3, 3), 5);
+    add(QDate(2024, 3, 4), 4);
+    add(QDate(2024, 3, 4), 1);
+    add(QDate(2024, 3, 5), 3);
+    add(QDate(2024, 3, 7), 5);
+    add(QDate(2024, 3, 9), 2);
+    add(QDate(2024, 3, 9), 4);
+    add(QDate(2024, 3, 11), 1);
+    return columns;
+}
+
+QJsonObject ComputeStatsTest::stats(const MoodColumns &columns, const QDate &from, const QDate &to)
+{
+    return QJsonDocument::fromJson(ComputeDatabase::computeStats(columns, from, to)).object();
+}
+
+void ComputeStatsTest::totals()
+{
+    const QJsonObject result = stats(sample(), From, To);
+    QCOMPARE(result["from"].toString(), QString("2024-03-04"));
+    QCOMPARE(result["to"].toString(), QString("2024-03-10"));
+    QCOMPARE(result["entryCount"].toInt(), 6);
+    QCOMPARE(result["activeDays"].toInt(), 4);
+    QCOMPARE(result["averageMood"].toDouble(), 3.17);   // 19 / 6
+
+    const QJsonArray distribution = result["distribution"].toArray();
+    QCOMPARE(distribution.size(), 5);
+    QCOMPARE(distribution[0].toObject()["moodId"].toInt(), 1);
+    QCOMPARE(distribution[3].toObject()["moodId"].toInt(), 4);
+    QCOMPARE(distribution[3].toObject()["count"].toInt(), 2);
+    QCOMPARE(distribution[4].toObject()["moodId"].toInt(), 5);
+}
+
+void ComputeStatsTest::daily()
+{
+    const QJsonArray daily = stats(sample(), From, To)["daily"].toArray();
+    QCOMPARE(daily.size(), 7);
+
+    const QJsonObject first = daily[0].toObject();
+    QCOMPARE(first["date"].toString(), QString("2024-03-04"));
+    QCOMPARE(first["count"].toInt(), 2);
+    QCOMPARE(first["average"].toDouble(), 2.5);
+    QCOMPARE(first["rolling7"].toDouble(), 3.0);    // с 28.02 и 03.03 из прошлой недели
+    QCOMPARE(first["rolling30"].toDouble(), 3.17);  // и 20.02
+
+    // день без записей: среднего нет, окна — по соседним дням
+    const QJsonObject empty = daily[2].toObject();
+    QCOMPARE(empty["count"].toInt(), 0);
+    QVERIFY(empty["average"].isNull());
+    QCOMPARE(empty["rolling7"].toDouble(), 3.25);
+    QCOMPARE(empty["rolling30"].toDouble(), 3.14);
+
+    const QJsonObject last = daily[6].toObject();
+    QCOMPARE(last["date"].toString(), QString("2024-03-10"));
+    QCOMPARE(last["rolling7"].toDouble(), 3.17);
+    QCOMPARE(last["rolling30"].toDouble(), 3.3);
+}
+
+void ComputeStatsTest::weeksStartOnMonday()
+{
+    const QJsonArray single = stats(sample(), From, To)["weekly"].toArray();
+    QCOMPARE(single.size(), 1);
+    QCOMPARE(single[0].toObject()["weekStart"].toString(), QString("2024-03-04"));
+    QCOMPARE(single[0].toObject()["count"].toInt(), 6);
+
+    // со среды по вторник: две недели, дни до from в первую не входят
+    const QJsonArray weekly = stats(sample(), QDate(2024, 3, 6), QDate(2024, 3, 12))["weekly"].toArray();
+    QCOMPARE(weekly.size(), 2);
+    QCOMPARE(weekly[0].toObject()["weekStart"].toString(), QString("2024-03-04"));
+    QCOMPARE(weekly[0].toObject()["count"].toInt(), 3);
+    QCOMPARE(weekly[0].toObject()["average"].toDouble(), 3.67);
+    QCOMPARE(weekly[1].toObject()["weekStart"].toString(), QString("2024-03-11"));
+    QCOMPARE(weekly[1].toObject()["count"].toInt(), 1);
+    QCOMPARE(weekly[1].toObject()["average"].toDouble(), 1.0);
+}
+
+void ComputeStatsTest::streaksClippedToRange()
+{
+    // серия 03.03–05.03 начинается до from: в диапазоне от неё два дня;
+    // to (10.03) без записей, поэтому текущая серия заканчивается 09.03
+    const QJsonObject streaks = stats(sample(), From, To)["streaks"].toObject();
+    QCOMPARE(streaks["longest"].toInt(), 2);
+    QCOMPARE(streaks["current"].toInt(), 1);
+
+    const QJsonObject untilTo = stats(sample(), From, QDate(2024, 3, 5))["streaks"].toObject();
+    QCOMPARE(untilTo["longest"].toInt(), 2);
+    QCOMPARE(untilTo["current"].toInt(), 2);
+
+    // 11.03 с записью лежит до from, а в диапазоне записей нет — серий нет
+    const QJsonObject none = stats(sample(), QDate(2024, 3, 12), QDate(2024, 3, 13))["streaks"].toObject();
+    QCOMPARE(none["longest"].toInt(), 0);
+    QCOMPARE(none["current"].toInt(), 0);
+}
+
+void ComputeStatsTest::previousAndDelta()
+{
+    const QJsonObject result = stats(sample(), From, To);
+    const QJsonObject previous = result["previous"].toObject();
+    QCOMPARE(previous["from"].toString(), QString("2024-02-26"));
+    QCOMPARE(previous["to"].toString(), QString("2024-03-03"));
+    QCOMPARE(previous["entryCount"].toInt(), 3);
+    QCOMPARE(previous["activeDays"].toInt(), 2);
+    QCOMPARE(previous["averageMood"].toDouble(), 3.33);
+
+    // 19/6 - 10/3 = -0.1667; разность округлённых средних дала бы -0.16
+    const QJsonObject delta = result["delta"].toObject();
+    QCOMPARE(delta["entryCount"].toInt(), 3);
+    QCOMPARE(delta["activeDays"].toInt(), 2);
+    QCOMPARE(delta["averageMood"].toDouble(), -0.17);
+}
+
+void ComputeStatsTest::emptyHistory()
+{
+    const QJsonObject result = stats(MoodColumns(), From, To);
+    QCOMPARE(result["entryCount"].toInt(), 0);
+    QCOMPARE(result["activeDays"].toInt(), 0);
+    QVERIFY(result["averageMood"].isNull());
+    QVERIFY(result["distribution"].toArray().isEmpty());
+    QCOMPARE(result["daily"].toArray().size(), 7);
+    QVERIFY(result["daily"].toArray()[0].toObject()["rolling30"].isNull());
+    QCOMPARE(result["weekly"].toArray().size(), 1);
+    QVERIFY(result["weekly"].toArray()[0].toObject()["average"].isNull());
+    QCOMPARE(result["streaks"].toObject()["longest"].toInt(), 0);
+    QVERIFY(result["previous"].toObject()["averageMood"].isNull());
+    QVERIFY(result["delta"].toObject()["averageMood"].isNull());
+}
+
+void ComputeStatsTest::invalidRange()
+{
+    QVERIFY(ComputeDatabase::computeStats(sample(), To, From).isEmpty());
+    QVERIFY(ComputeDatabase::computeStats(sample(), QDate(), To).isEmpty());
+}
+
+QTEST_APPLESS_MAIN(ComputeStatsTest)
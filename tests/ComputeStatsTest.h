@@ -0,0 +1,28 @@
+#ifndef COMPUTESTATSTEST_H
+#define COMPUTESTATSTEST_H
+
+#include <QObject>
+#include <QJsonObject>
+#include "ComputeDatabase.h"
+
+// ComputeDatabase::computeStats по MoodColumns должна отвечать тем же, что
+// SQL по daily_mood_stats: ожидаемые значения посчитаны по формулам запроса.
+class ComputeStatsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void totals();
+    void daily();
+    void weeksStartOnMonday();
+    void streaksClippedToRange();
+    void previousAndDelta();
+    void emptyHistory();
+    void invalidRange();
+
+private:
+    static MoodColumns sample();
+    static QJsonObject stats(const MoodColumns &columns, const QDate &from, const QDate &to);
+};
+
+#endif // COMPUTESTATSTEST_H
@@ -0,0 +1,147 @@
+#include "CorrelationEngineTest.h"
+
+#include <QtTest>
+
+namespace {
+
+const QDate Day1(2024, 3, 1);
+
+} // namespace
+
+// Шесть записей, среднее настроение 3. Активность 1 — в хороших днях,
+// 3 — в плохих, 9 встречается один раз; эмоция 8 — в плохих днях.
+MoodColumns CorrelationEngineTest::sample()
+{
+    MoodColumns columns;
+    columns.append(1, Day1, QTime(9, 0), 5, {1, 2, 9}, {7});
+    columns.append(2, Day1.addDays(1), QTime(9, 0), 5, {1}, {});
+    columns.append(3, Day1.addDays(2), QTime(9, 0), 4, {1, 3}, {7});
+    columns.append(4, Day1.addDays(3), QTime(9, 0), 1, {2, 3}, {8});
+    columns.append(5, Day1.addDays(4), QTime(9, 0), 1, {2, 3}, {8});
+    columns.append(6, Day1.addDays(5), QTime(9, 0), 2, {3}, {7, 8});
+    return columns;
+}
+
+CorrelationEngine::Result CorrelationEngineTest::compute(int minCount, int limit)
+{
+    const MoodColumns columns = sample();
+    CorrelationEngine::Options options;
+    options.minCount = minCount;
+    options.limit = limit;
+    return CorrelationEngine::compute(columns, 0, columns.size(), options);
+}
+
+QList<int> CorrelationEngineTest::ids(const QList<CorrelationEngine::Item> &items)
+{
+    QList<int> result;
+    for (const CorrelationEngine::Item &item : items)
+        result.append(item.id);
+    return result;
+}
+
+const CorrelationEngine::Item *CorrelationEngineTest::find(const QList<CorrelationEngine::Item> &items, int id)
+{
+    for (const CorrelationEngine::Item &item : items) {
+        if (item.id == id)
+            return &item;
+    }
+    return nullptr;
+}
+
+void CorrelationEngineTest::summary()
+{
+    const CorrelationEngine::Result result = compute(3);
+    QCOMPARE(result.entryCount, 6);
+    QCOMPARE(result.averageMood, 3.0);
+    QCOMPARE(result.moodLevels, QList<int>({1, 2, 4, 5}));
+}
+
+void CorrelationEngineTest::averageAndLift()
+{
+    const CorrelationEngine::Result result = compute(3);
+
+    // 1: с ней 5, 5, 4, без неё 1, 1, 2
+    const CorrelationEngine::Item *good = find(result.activities, 1);
+    QVERIFY(good);
+    QCOMPARE(good->count, 3);
+    QCOMPARE(good->averageMood, 14.0 / 3);
+    QCOMPARE(good->lift, 14.0 / 3 - 4.0 / 3);
+
+    // 3: с ней 4, 1, 1, 2, без неё 5, 5
+    const CorrelationEngine::Item *bad = find(result.activities, 3);
+    QVERIFY(bad);
+    QCOMPARE(bad->count, 4);
+    QCOMPARE(bad->averageMood, 2.0);
+    QCOMPARE(bad->lift, -3.0);
+
+    const CorrelationEngine::Item *emotion = find(result.emotions, 8);
+    QVERIFY(emotion);
+    QCOMPARE(emotion->count, 3);
+    QCOMPARE(emotion->lift, 4.0 / 3 - 14.0 / 3);
+}
+
+void CorrelationEngineTest::orderedByAbsoluteLift()
+{
+    const CorrelationEngine::Result result = compute(3);
+    // |lift|: 3.33, 3, 1.33 — знак на порядок не влияет
+    QCOMPARE(ids(result.activities), QList<int>({1, 3, 2}));
+    QCOMPARE(ids(result.emotions), QList<int>({8, 7}));
+}
+
+void CorrelationEngineTest::moodCounts()
+{
+    const CorrelationEngine::Result result = compute(3);
+    // по уровням 1, 2, 4, 5
+    QCOMPARE(find(result.activities, 1)->moodCounts, QList<int>({0, 0, 1, 2}));
+    QCOMPARE(find(result.activities, 2)->moodCounts, QList<int>({2, 0, 0, 1}));
+    QCOMPARE(find(result.activities, 3)->moodCounts, QList<int>({2, 1, 1, 0}));
+    QCOMPARE(find(result.emotions, 7)->moodCounts, QList<int>({0, 1, 1, 1}));
+}
+
+void CorrelationEngineTest::minCountFilters()
+{
+    QVERIFY(!find(compute(3).activities, 9));
+
+    const CorrelationEngine::Result all = compute(1);
+    const CorrelationEngine::Item *rare = find(all.activities, 9);
+    QVERIFY(rare);
+    QCOMPARE(rare->count, 1);
+    QCOMPARE(rare->lift, 5.0 - 13.0 / 5);
+    QCOMPARE(ids(all.activities), QList<int>({1, 3, 9, 2}));
+
+    QCOMPARE(ids(compute(4).activities), QList<int>({3}));
+    QCOMPARE(ids(compute(4).emotions), QList<int>());
+}
+
+void CorrelationEngineTest::limitKeepsStrongest()
+{
+    QCOMPARE(ids(compute(1, 2).activities), QList<int>({1, 3}));
+    QCOMPARE(ids(compute(1, 1).emotions), QList<int>({8}));
+}
+
+void CorrelationEngineTest::liftWithoutComplement()
+{
+    // В первых двух записях активность 1 есть всегда: сравнивать не с чем
+    const MoodColumns columns = sample();
+    CorrelationEngine::Options options;
+    options.minCount = 1;
+    const CorrelationEngine::Result result = CorrelationEngine::compute(columns, 0, 2, options);
+    QCOMPARE(result.entryCount, 2);
+    const CorrelationEngine::Item *always = find(result.activities, 1);
+    QVERIFY(always);
+    QCOMPARE(always->count, 2);
+    QCOMPARE(always->lift, 0.0);
+    QVERIFY(result.emotions.size() == 1);
+}
+
+void CorrelationEngineTest::emptyRange()
+{
+    const MoodColumns columns = sample();
+    const CorrelationEngine::Result result = CorrelationEngine::compute(columns, 3, 3, CorrelationEngine::Options());
+    QCOMPARE(result.entryCount, 0);
+    QVERIFY(result.moodLevels.isEmpty());
+    QVERIFY(result.activities.isEmpty());
+    QVERIFY(result.emotions.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(CorrelationEngineTest)
@@ -0,0 +1,31 @@
+#ifndef CORRELATIONENGINETEST_H
+#define CORRELATIONENGINETEST_H
+
+#include <QObject>
+#include <QList>
+#include "CorrelationEngine.h"
+
+// Подъём, порог minCount и порядок по |lift| в CorrelationEngine на
+// небольшой истории, посчитанной вручную.
+class CorrelationEngineTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void summary();
+    void averageAndLift();
+    void orderedByAbsoluteLift();
+    void moodCounts();
+    void minCountFilters();
+    void limitKeepsStrongest();
+    void liftWithoutComplement();
+    void emptyRange();
+
+private:
+    static MoodColumns sample();
+    static CorrelationEngine::Result compute(int minCount, int limit = 10);
+    static QList<int> ids(const QList<CorrelationEngine::Item> &items);
+    static const CorrelationEngine::Item *find(const QList<CorrelationEngine::Item> &items, int id);
+};
+
+#endif // CORRELATIONENGINETEST_H
@@ -0,0 +1,172 @@
+#include "MoodColumnsTest.h"
+
+#include <QtTest>
+
+namespace {
+
+const QDate Day1(2024, 3, 1);
+const QDate Day2(2024, 3, 2);
+const QDate Day3(2024, 3, 4);
+
+} // namespace
+
+// Три записи в разные дни, у средней связей нет совсем
+MoodColumns MoodColumnsTest::sample()
+{
+    MoodColumns columns;
+    columns.append(10, Day1, QTime(9, 0), 3, {1, 2}, {7});
+    columns.append(20, Day2, QTime(12, 0), -2, {}, {});
+    columns.append(30, Day3, QTime(18, 30), 5, {3}, {8, 9});
+    return columns;
+}
+
+QList<int> MoodColumnsTest::ids(const MoodColumns &columns)
+{
+    return QList<int>(columns.entryIds.cbegin(), columns.entryIds.cend());
+}
+
+QList<int> MoodColumnsTest::activities(const MoodColumns &columns, std::size_t row)
+{
+    return QList<int>(columns.activityIds.cbegin() + columns.activityOffsets[row],
+                      columns.activityIds.cbegin() + columns.activityOffsets[row + 1]);
+}
+
+QList<int> MoodColumnsTest::emotions(const MoodColumns &columns, std::size_t row)
+{
+    return QList<int>(columns.emotionIds.cbegin() + columns.emotionOffsets[row],
+                      columns.emotionIds.cbegin() + columns.emotionOffsets[row + 1]);
+}
+
+void MoodColumnsTest::verifyOffsets(const MoodColumns &columns)
+{
+    QCOMPARE(columns.days.size(), columns.size());
+    QCOMPARE(columns.times.size(), columns.size());
+    QCOMPARE(columns.entryIds.size(), columns.size());
+    QCOMPARE(columns.activityOffsets.size(), columns.size() + 1);
+    QCOMPARE(columns.emotionOffsets.size(), columns.size() + 1);
+    QCOMPARE(columns.activityOffsets.front(), 0u);
+    QCOMPARE(columns.emotionOffsets.front(), 0u);
+    QCOMPARE(std::size_t(columns.activityOffsets.back()), columns.activityIds.size());
+    QCOMPARE(std::size_t(columns.emotionOffsets.back()), columns.emotionIds.size());
+    QVERIFY(std::is_sorted(columns.activityOffsets.cbegin(), columns.activityOffsets.cend()));
+    QVERIFY(std::is_sorted(columns.emotionOffsets.cbegin(), columns.emotionOffsets.cend()));
+    QVERIFY(std::is_sorted(columns.days.cbegin(), columns.days.cend()));
+}
+
+void MoodColumnsTest::appendKeepsOffsets()
+{
+    const MoodColumns columns = sample();
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20, 30}));
+    QCOMPARE(activities(columns, 0), QList<int>({1, 2}));
+    QCOMPARE(activities(columns, 1), QList<int>());
+    QCOMPARE(activities(columns, 2), QList<int>({3}));
+    QCOMPARE(emotions(columns, 2), QList<int>({8, 9}));
+    QCOMPARE(int(columns.moods[1]), -2);
+}
+
+void MoodColumnsTest::insertAtStart()
+{
+    MoodColumns columns = sample();
+    columns.insert(5, Day1.addDays(-1), QTime(23, 0), 1, {4, 5, 6}, {});
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({5, 10, 20, 30}));
+    QCOMPARE(activities(columns, 0), QList<int>({4, 5, 6}));
+    QCOMPARE(emotions(columns, 0), QList<int>());
+    QCOMPARE(activities(columns, 1), QList<int>({1, 2}));
+    QCOMPARE(emotions(columns, 1), QList<int>({7}));
+    QCOMPARE(activities(columns, 3), QList<int>({3}));
+    QCOMPARE(emotions(columns, 3), QList<int>({8, 9}));
+}
+
+void MoodColumnsTest::insertInMiddle()
+{
+    MoodColumns columns = sample();
+    columns.insert(25, Day2.addDays(1), QTime(8, 0), 4, {11}, {12, 13});
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20, 25, 30}));
+    QCOMPARE(activities(columns, 1), QList<int>());
+    QCOMPARE(activities(columns, 2), QList<int>({11}));
+    QCOMPARE(emotions(columns, 2), QList<int>({12, 13}));
+    QCOMPARE(activities(columns, 3), QList<int>({3}));
+    QCOMPARE(emotions(columns, 3), QList<int>({8, 9}));
+    QCOMPARE(int(columns.moods[2]), 4);
+}
+
+void MoodColumnsTest::insertAtEnd()
+{
+    MoodColumns columns = sample();
+    columns.insert(40, Day3.addDays(1), QTime(7, 0), 2, {14}, {15});
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20, 30, 40}));
+    QCOMPARE(activities(columns, 2), QList<int>({3}));
+    QCOMPARE(activities(columns, 3), QList<int>({14}));
+    QCOMPARE(emotions(columns, 3), QList<int>({15}));
+}
+
+void MoodColumnsTest::insertOrdersByTimeAndId()
+{
+    MoodColumns columns = sample();
+    columns.insert(21, Day2, QTime(8, 0), 1, {}, {});      // раньше записи 20 в тот же день
+    columns.insert(22, Day2, QTime(12, 0), 1, {}, {});     // то же время, больший id
+    columns.insert(19, Day2, QTime(12, 0), 1, {}, {});     // то же время, меньший id
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 21, 19, 20, 22, 30}));
+}
+
+void MoodColumnsTest::removeAtStart()
+{
+    MoodColumns columns = sample();
+    QVERIFY(columns.remove(10));
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({20, 30}));
+    QCOMPARE(activities(columns, 0), QList<int>());
+    QCOMPARE(activities(columns, 1), QList<int>({3}));
+    QCOMPARE(emotions(columns, 1), QList<int>({8, 9}));
+}
+
+void MoodColumnsTest::removeInMiddle()
+{
+    MoodColumns columns = sample();
+    columns.insert(25, Day2.addDays(1), QTime(8, 0), 4, {11}, {12, 13});
+    QVERIFY(columns.remove(25));
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20, 30}));
+    QCOMPARE(activities(columns, 0), QList<int>({1, 2}));
+    QCOMPARE(emotions(columns, 0), QList<int>({7}));
+    QCOMPARE(activities(columns, 2), QList<int>({3}));
+    QCOMPARE(emotions(columns, 2), QList<int>({8, 9}));
+}
+
+void MoodColumnsTest::removeAtEnd()
+{
+    MoodColumns columns = sample();
+    QVERIFY(columns.remove(30));
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20}));
+    QCOMPARE(activities(columns, 0), QList<int>({1, 2}));
+    QCOMPARE(emotions(columns, 0), QList<int>({7}));
+    QVERIFY(columns.activityIds.size() == 2);
+}
+
+void MoodColumnsTest::removeMissing()
+{
+    MoodColumns columns = sample();
+    QVERIFY(!columns.remove(99));
+    verifyOffsets(columns);
+    QCOMPARE(ids(columns), QList<int>({10, 20, 30}));
+}
+
+void MoodColumnsTest::range()
+{
+    const MoodColumns columns = sample();
+    using Range = std::pair<std::size_t, std::size_t>;
+    QCOMPARE(columns.range(Day1, Day3.addDays(1)), Range(0, 3));
+    QCOMPARE(columns.range(Day2, Day3), Range(1, 2));            // to не входит
+    QCOMPARE(columns.range(Day2.addDays(1), Day3), Range(2, 2)); // пустой промежуток между днями
+    QCOMPARE(columns.range(Day1.addDays(-10), Day1), Range(0, 0));
+    QCOMPARE(columns.range(Day3.addDays(1), Day3.addDays(5)), Range(3, 3));
+    QCOMPARE(MoodColumns().range(Day1, Day3), Range(0, 0));
+}
+
+QTEST_APPLESS_MAIN(MoodColumnsTest)
@@ -0,0 +1,34 @@
+#ifndef MOODCOLUMNSTEST_H
+#define MOODCOLUMNSTEST_H
+
+#include <QObject>
+#include <QList>
+#include "MoodColumns.h"
+
+// Порядок строк и смещения связей MoodColumns: ошибка на единицу в
+// insert()/remove() молча сдвигает активности и эмоции всех следующих записей.
+class MoodColumnsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendKeepsOffsets();
+    void insertAtStart();
+    void insertInMiddle();
+    void insertAtEnd();
+    void insertOrdersByTimeAndId();
+    void removeAtStart();
+    void removeInMiddle();
+    void removeAtEnd();
+    void removeMissing();
+    void range();
+
+private:
+    static MoodColumns sample();
+    static QList<int> ids(const MoodColumns &columns);
+    static QList<int> activities(const MoodColumns &columns, std::size_t row);
+    static QList<int> emotions(const MoodColumns &columns, std::size_t row);
+    static void verifyOffsets(const MoodColumns &columns);
+};
+
+#endif // MOODCOLUMNSTEST_H
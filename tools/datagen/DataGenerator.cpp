@@ -0,0 +1,343 @@
+#include "DataGenerator.h"
+
+#include <QCryptographicHash>
+#include <QTime>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const char *const words[] = {
+    "сегодня", "утром", "вечером", "работа", "проект", "встреча", "прогулка", "парк", "кофе", "друзья",
+    "семья", "книга", "фильм", "спорт", "бег", "сон", "усталость", "радость", "тревога", "спокойствие",
+    "погода", "дождь", "солнце", "город", "дорога", "обед", "ужин", "музыка", "концерт", "учёба",
+    "экзамен", "отпуск", "море", "горы", "планы", "мысли", "разговор", "звонок", "подарок", "праздник",
+    "болит", "голова", "энергия", "настроение", "благодарность", "цель", "привычка", "медитация", "йога", "\"важно\""
+};
+constexpr int wordCount = int(sizeof(words) / sizeof(words[0]));
+
+const char *const activityLabels[] = {
+    "Работа", "Спорт", "Чтение", "Прогулка", "Готовка", "Учёба", "Игры", "Уборка", "Покупки", "Встречи", "Сон", "Музыка"
+};
+const char *const emotionLabels[] = {
+    "Радость", "Грусть", "Злость", "Спокойствие", "Тревога", "Усталость", "Вдохновение", "Скука", "Любовь", "Страх"
+};
+
+// Текстовый формат COPY: поля через табуляцию, спецсимволы через обратный слэш
+void appendField(QByteArray &out, const QByteArray &value)
+{
+    for (const char c : value) {
+        switch (c) {
+        case '\\': out.append("\\\\"); break;
+        case '\t': out.append("\\t"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        default: out.append(c);
+        }
+    }
+}
+
+template <typename... Fields>
+void appendRow(QByteArray &out, const Fields &... fields)
+{
+    bool first = true;
+    auto append = [&](const QByteArray &field) {
+        if (!first)
+            out.append('\t');
+        first = false;
+        appendField(out, field);
+    };
+    (append(QByteArray(fields)), ...);
+    out.append('\n');
+}
+
+QByteArray number(qint64 value)
+{
+    return QByteArray::number(value);
+}
+
+// Выбирает count различных значений из [first, first + range)
+QVector<int> pickDistinct(std::mt19937_64 &random, int first, int range, int count)
+{
+    QVector<int> values;
+    count = qMin(count, range);
+    while (values.size() < count) {
+        const int value = first + int(random() % quint64(range));
+        if (!values.contains(value))
+            values.append(value);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+} // namespace
+
+DataGenerator::DataGenerator(const Options &options)
+    : m_options(options)
+    , m_passwordHash(QCryptographicHash::hash(options.password.toUtf8(), QCryptographicHash::Sha256).toHex())
+{
+}
+
+DataGenerator::~DataGenerator()
+{
+    if (m_connection)
+        PQfinish(m_connection);
+}
+
+bool DataGenerator::run()
+{
+    m_connection = PQconnectdb(m_options.conninfo.constData());
+    if (PQstatus(m_connection) != CONNECTION_OK) {
+        std::fprintf(stderr, "Connection failed: %s", PQerrorMessage(m_connection));
+        return false;
+    }
+
+    if (!execute("BEGIN"))
+        return false;
+    if (m_options.truncate && !truncateTables())
+        return false;
+
+    for (int first = 0; first < m_options.users; first += m_options.batchUsers) {
+        const int last = qMin(m_options.users, first + m_options.batchUsers);
+
+        Batch batch;
+        for (int user = first; user < last; ++user)
+            generateUser(user, batch);
+
+        // порядок важен из-за внешних ключей
+        const bool ok =
+            copy("COPY users (id, user_login, user_email, user_passhach) FROM STDIN", batch.users)
+            && copy("COPY folders (id, name, user_login, itemcount) FROM STDIN", batch.folders)
+            && copy("COPY user_tags (id, name, user_login) FROM STDIN", batch.tags)
+            && copy("COPY user_activities (id, user_login, icon_id, icon_label) FROM STDIN", batch.activities)
+            && copy("COPY user_emotions (id, user_login, icon_id, icon_label) FROM STDIN", batch.emotions)
+            && copy("COPY user_todo (user_login, name) FROM STDIN", batch.todos)
+            && copy("COPY entries (id, user_login, entry_title, entry_content, entry_mood_id, entry_folder_id, "
+                    "entry_date, entry_time) FROM STDIN", batch.entries)
+            && copy("COPY entry_tags (entry_id, tag_id) FROM STDIN", batch.entryTags)
+            && copy("COPY entry_user_activities (entry_id, user_activity_id) FROM STDIN", batch.entryActivities)
+            && copy("COPY entry_user_emotions (entry_id, user_emotion_id) FROM STDIN", batch.entryEmotions);
+        if (!ok)
+            return false;
+
+        std::fprintf(stderr, "users %d/%d, entries %llu\n", last, m_options.users,
+                     static_cast<unsigned long long>(m_entryCount));
+    }
+
+    if (!resetSequences() || !rebuildDailyMoodStats() || !execute("COMMIT"))
+        return false;
+
+    // свежие данные без статистики планировщик оценивает плохо
+    execute("ANALYZE");
+    return true;
+}
+
+bool DataGenerator::execute(const char *sql)
+{
+    PGresult *result = PQexec(m_connection, sql);
+    const ExecStatusType status = PQresultStatus(result);
+    const bool ok = status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK;
+    if (!ok)
+        std::fprintf(stderr, "%s failed: %s", sql, PQerrorMessage(m_connection));
+    PQclear(result);
+    return ok;
+}
+
+bool DataGenerator::copy(const char *statement, const QByteArray &data)
+{
+    if (data.isEmpty())
+        return true;
+
+    PGresult *result = PQexec(m_connection, statement);
+    const bool started = PQresultStatus(result) == PGRES_COPY_IN;
+    PQclear(result);
+    if (!started) {
+        std::fprintf(stderr, "%s failed: %s", statement, PQerrorMessage(m_connection));
+        return false;
+    }
+
+    constexpr qsizetype chunk = 1 << 20;
+    for (qsizetype offset = 0; offset < data.size(); offset += chunk) {
+        const int size = int(qMin(chunk, data.size() - offset));
+        if (PQputCopyData(m_connection, data.constData() + offset, size) != 1) {
+            std::fprintf(stderr, "COPY data failed: %s", PQerrorMessage(m_connection));
+            return false;
+        }
+    }
+
+    if (PQputCopyEnd(m_connection, nullptr) != 1) {
+        std::fprintf(stderr, "COPY end failed: %s", PQerrorMessage(m_connection));
+        return false;
+    }
+
+    bool ok = true;
+    while ((result = PQgetResult(m_connection)) != nullptr) {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+            std::fprintf(stderr, "%s failed: %s", statement, PQresultErrorMessage(result));
+            ok = false;
+        }
+        PQclear(result);
+    }
+    return ok;
+}
+
+bool DataGenerator::truncateTables()
+{
+    return execute("TRUNCATE entry_tags, entry_user_activities, entry_user_emotions, entries, "
+                   "user_todo, user_emotions, user_activities, user_tags, folders, users "
+                   "RESTART IDENTITY CASCADE");
+}
+
+bool DataGenerator::resetSequences()
+{
+    static const char *const tables[] = {
+        "users", "folders", "user_tags", "user_activities", "user_emotions", "entries"
+    };
+
+    for (const char *table : tables) {
+        const QByteArray sql = QByteArray("SELECT setval(pg_get_serial_sequence('") + table + "', 'id'), "
+                               "COALESCE((SELECT MAX(id) FROM " + table + "), 0) + 1, false)";
+        if (!execute(sql.constData()))
+            return false;
+    }
+    return true;
+}
+
+bool DataGenerator::rebuildDailyMoodStats()
+{
+    // COPY обходит EntriesDatabase, поэтому сводку по дням сервер сам не обновит.
+    // Таблицу создаёт сервер при старте; если её ещё нет, он же заполнит её с нуля.
+    return execute(R"(
+        DO $$
+        BEGIN
+            IF to_regclass('daily_mood_stats') IS NOT NULL THEN
+                TRUNCATE daily_mood_stats;
+                INSERT INTO daily_mood_stats (user_login, stat_date, entry_count, mood_sum, mood_min, mood_max,
+                                              last_mood, last_time, last_entry_id)
+                SELECT user_login, entry_date, COUNT(*), SUM(entry_mood_id), MIN(entry_mood_id), MAX(entry_mood_id),
+                       (ARRAY_AGG(entry_mood_id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1],
+                       MAX(COALESCE(entry_time, TIME '00:00')),
+                       (ARRAY_AGG(id ORDER BY COALESCE(entry_time, TIME '00:00') DESC, id DESC))[1]
+                FROM entries
+                WHERE entry_mood_id IS NOT NULL
+                GROUP BY user_login, entry_date;
+            END IF;
+        END
+        $$
+    )");
+}
+
+void DataGenerator::generateUser(int user, Batch &batch)
+{
+    // У каждого пользователя свой генератор: данные пользователя не зависят
+    // от размера порции и от того, сколько пользователей генерируется всего.
+    std::mt19937_64 random(m_options.seed ^ (quint64(user + 1) * 0x9E3779B97F4A7C15ull));
+
+    const QByteArray login = (m_options.userPrefix + QString::number(user)).toUtf8();
+    appendRow(batch.users, number(user + 1), login, login + "@example.com", m_passwordHash);
+
+    const int folderBase = user * m_options.foldersPerUser;
+    const int tagBase = user * m_options.tagsPerUser;
+    const int activityBase = user * m_options.activitiesPerUser;
+    const int emotionBase = user * m_options.emotionsPerUser;
+
+    for (int i = 0; i < m_options.tagsPerUser; ++i)
+        appendRow(batch.tags, number(tagBase + i + 1), sentence(random, 1).toUtf8() + ' ' + number(i + 1), login);
+
+    for (int i = 0; i < m_options.activitiesPerUser; ++i) {
+        const int label = i % int(sizeof(activityLabels) / sizeof(activityLabels[0]));
+        appendRow(batch.activities, number(activityBase + i + 1), login, number(label + 1),
+                  QByteArray(activityLabels[label]));
+    }
+
+    for (int i = 0; i < m_options.emotionsPerUser; ++i) {
+        const int label = i % int(sizeof(emotionLabels) / sizeof(emotionLabels[0]));
+        appendRow(batch.emotions, number(emotionBase + i + 1), login, number(label + 1),
+                  QByteArray(emotionLabels[label]));
+    }
+
+    for (int i = 0; i < m_options.todosPerUser; ++i)
+        appendRow(batch.todos, login, sentence(random, 3).toUtf8());
+
+    // Настроение держится несколько дней и медленно дрейфует, как у живых людей
+    QVector<int> folderCounts(m_options.foldersPerUser, 0);
+    std::poisson_distribution<int> perDay(m_options.entriesPerDay);
+    std::uniform_int_distribution<int> minuteOfDay(7 * 60, 24 * 60 - 1);
+    std::uniform_int_distribution<int> moodStep(-1, 1);
+    int baseMood = 2;
+
+    const QDate start = m_options.endDate.addYears(-m_options.years).addDays(1);
+    for (QDate date = start; date <= m_options.endDate; date = date.addDays(1)) {
+        const int count = perDay(random);
+        if (count == 0)
+            continue;
+
+        baseMood = qBound(0, baseMood + (random() % 4 == 0 ? moodStep(random) : 0), 4);
+
+        QVector<int> minutes;
+        for (int i = 0; i < count; ++i)
+            minutes.append(minuteOfDay(random));
+        std::sort(minutes.begin(), minutes.end());
+
+        for (int minute : minutes) {
+            const qint64 entryId = m_nextEntryId++;
+            const int folder = int(random() % quint64(m_options.foldersPerUser));
+            const int mood = qBound(0, baseMood + moodStep(random), 4);
+            const int paragraphs = 1 + int(random() % 6);
+            ++folderCounts[folder];
+            ++m_entryCount;
+
+            appendRow(batch.entries, number(entryId), login, sentence(random, 2 + int(random() % 5)).toUtf8(),
+                      htmlContent(random, paragraphs).toUtf8(), number(mood), number(folderBase + folder + 1),
+                      date.toString(Qt::ISODate).toLatin1(),
+                      QTime(0, 0).addSecs(minute * 60 + int(random() % 60)).toString("HH:mm:ss").toLatin1());
+
+            for (int id : pickDistinct(random, tagBase + 1, m_options.tagsPerUser, int(random() % 5)))
+                appendRow(batch.entryTags, number(entryId), number(id));
+            for (int id : pickDistinct(random, activityBase + 1, m_options.activitiesPerUser, int(random() % 4)))
+                appendRow(batch.entryActivities, number(entryId), number(id));
+            for (int id : pickDistinct(random, emotionBase + 1, m_options.emotionsPerUser, int(random() % 4)))
+                appendRow(batch.entryEmotions, number(entryId), number(id));
+        }
+    }
+
+    for (int i = 0; i < m_options.foldersPerUser; ++i) {
+        const QByteArray name = i == 0 ? QByteArray("Дневник") : "Папка " + number(i + 1);
+        appendRow(batch.folders, number(folderBase + i + 1), name, login, number(folderCounts[i]));
+    }
+}
+
+QString DataGenerator::sentence(std::mt19937_64 &random, int wordsInSentence)
+{
+    QString text;
+    for (int i = 0; i < wordsInSentence; ++i) {
+        if (i > 0)
+            text += ' ';
+        text += QString::fromUtf8(words[random() % wordCount]);
+    }
+    if (!text.isEmpty())
+        text[0] = text[0].toUpper();
+    return text;
+}
+
+QString DataGenerator::htmlContent(std::mt19937_64 &random, int paragraphs)
+{
+    QString html;
+    for (int p = 0; p < paragraphs; ++p) {
+        html += "<p>";
+        const int sentences = 1 + int(random() % 5);
+        for (int s = 0; s < sentences; ++s) {
+            QString text = sentence(random, 4 + int(random() % 12));
+            if (random() % 5 == 0)
+                text = "<b>" + text + "</b>";
+            else if (random() % 7 == 0)
+                text = "<i>" + text + "</i>";
+            html += text + ". ";
+        }
+        html += "</p>";
+        if (random() % 4 == 0)
+            html += "<br>\n";
+    }
+    return html;
+}
@@ -0,0 +1,73 @@
+#ifndef DATAGENERATOR_H
+#define DATAGENERATOR_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QString>
+#include <libpq-fe.h>
+#include <random>
+
+// Заполняет базу синтетическими пользователями и их данными через COPY.
+// id выдаются явно и детерминированно, после загрузки последовательности
+// сдвигаются через setval. Раскладка id совпадает с той, что ожидает
+// tools/loadgen: у пользователя u (с нуля) папки имеют id u*folders+1 ..
+// (u+1)*folders, так же теги, активности и эмоции; логин — <prefix><u>.
+class DataGenerator
+{
+public:
+    struct Options {
+        QByteArray conninfo = "host=localhost dbname=MindTraceMainDB user=postgres password=123";
+        int users = 100;
+        QString userPrefix = "loaduser";
+        QString password = "password";
+        int foldersPerUser = 3;
+        int tagsPerUser = 10;
+        int activitiesPerUser = 8;
+        int emotionsPerUser = 8;
+        int todosPerUser = 5;
+        int years = 3;
+        double entriesPerDay = 1.2;    // среднее, число записей за день распределено по Пуассону
+        QDate endDate = QDate::currentDate();
+        quint64 seed = 42;
+        bool truncate = false;
+        int batchUsers = 200;          // пользователей в одной порции COPY
+    };
+
+    explicit DataGenerator(const Options &options);
+    ~DataGenerator();
+
+    bool run();
+
+private:
+    // Буферы в текстовом формате COPY для одной порции пользователей
+    struct Batch {
+        QByteArray users;
+        QByteArray folders;
+        QByteArray tags;
+        QByteArray activities;
+        QByteArray emotions;
+        QByteArray todos;
+        QByteArray entries;
+        QByteArray entryTags;
+        QByteArray entryActivities;
+        QByteArray entryEmotions;
+    };
+
+    bool execute(const char *sql);
+    bool copy(const char *statement, const QByteArray &data);
+    bool truncateTables();
+    bool resetSequences();
+    bool rebuildDailyMoodStats();
+
+    void generateUser(int user, Batch &batch);
+    QString htmlContent(std::mt19937_64 &random, int paragraphs);
+    QString sentence(std::mt19937_64 &random, int words);
+
+    Options m_options;
+    PGconn *m_connection = nullptr;
+    QByteArray m_passwordHash;
+    qint64 m_nextEntryId = 1;
+    quint64 m_entryCount = 0;
+};
+
+#endif // DATAGENERATOR_H
@@ -0,0 +1,67 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <cstdio>
+#include "DataGenerator.h"
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("psqlserver-datagen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fills a PSQLSERVER database with deterministic synthetic data via COPY.");
+    parser.addHelpOption();
+
+    const DataGenerator::Options defaults;
+    const QCommandLineOption conninfoOption("conninfo", "libpq connection string.", "conninfo", QString::fromUtf8(defaults.conninfo));
+    const QCommandLineOption usersOption("users", "Number of users.", "n", QString::number(defaults.users));
+    const QCommandLineOption userPrefixOption("user-prefix", "Login prefix.", "prefix", defaults.userPrefix);
+    const QCommandLineOption passwordOption("password", "Password of every generated user.", "password", defaults.password);
+    const QCommandLineOption foldersOption("folders", "Folders per user.", "n", QString::number(defaults.foldersPerUser));
+    const QCommandLineOption tagsOption("tags", "Tags per user.", "n", QString::number(defaults.tagsPerUser));
+    const QCommandLineOption activitiesOption("activities", "Activities per user.", "n", QString::number(defaults.activitiesPerUser));
+    const QCommandLineOption emotionsOption("emotions", "Emotions per user.", "n", QString::number(defaults.emotionsPerUser));
+    const QCommandLineOption todosOption("todos", "Todo items per user.", "n", QString::number(defaults.todosPerUser));
+    const QCommandLineOption yearsOption("years", "Years of entries per user.", "n", QString::number(defaults.years));
+    const QCommandLineOption perDayOption("entries-per-day", "Average entries per day.", "n", QString::number(defaults.entriesPerDay));
+    const QCommandLineOption endDateOption("end-date", "Last day with entries (yyyy-MM-dd). Fix it to reproduce a dataset exactly.",
+                                           "date", defaults.endDate.toString(Qt::ISODate));
+    const QCommandLineOption seedOption("seed", "Random seed.", "seed", QString::number(defaults.seed));
+    const QCommandLineOption truncateOption("truncate", "Remove all existing data before loading.");
+    parser.addOptions({ conninfoOption, usersOption, userPrefixOption, passwordOption, foldersOption, tagsOption,
+                        activitiesOption, emotionsOption, todosOption, yearsOption, perDayOption, endDateOption,
+                        seedOption, truncateOption });
+    parser.process(app);
+
+    DataGenerator::Options options;
+    options.conninfo = parser.value(conninfoOption).toUtf8();
+    options.users = qMax(1, parser.value(usersOption).toInt());
+    options.userPrefix = parser.value(userPrefixOption);
+    options.password = parser.value(passwordOption);
+    options.foldersPerUser = qMax(1, parser.value(foldersOption).toInt());
+    options.tagsPerUser = qMax(0, parser.value(tagsOption).toInt());
+    options.activitiesPerUser = qMax(0, parser.value(activitiesOption).toInt());
+    options.emotionsPerUser = qMax(0, parser.value(emotionsOption).toInt());
+    options.todosPerUser = qMax(0, parser.value(todosOption).toInt());
+    options.years = qMax(1, parser.value(yearsOption).toInt());
+    options.entriesPerDay = qMax(0.0, parser.value(perDayOption).toDouble());
+    options.endDate = QDate::fromString(parser.value(endDateOption), Qt::ISODate);
+    options.seed = parser.value(seedOption).toULongLong();
+    options.truncate = parser.isSet(truncateOption);
+
+    if (!options.endDate.isValid()) {
+        std::fprintf(stderr, "Invalid --end-date\n");
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    DataGenerator generator(options);
+    if (!generator.run())
+        return 1;
+
+    std::fprintf(stderr, "Done in %.1f s\n", double(timer.elapsed()) / 1000.0);
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include "LoadGenerator.h"
+
+#include <QDate>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QTextStream>
+#include <QTime>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+QList<Scenario> Scenario::loadJsonLines(const QString &fileName, QString *error)
+{
+    QList<Scenario> scenarios;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("Cannot open %1: %2").arg(fileName, file.errorString());
+        return {};
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            *error = QString("%1:%2: %3").arg(fileName).arg(lineNumber).arg(parseError.errorString());
+            return {};
+        }
+
+        const QJsonObject obj = doc.object();
+        Scenario scenario;
+        scenario.id = obj.value("request_id").toString();
+        scenario.title = obj.value("title").toString();
+        scenario.method = obj.value("method").toString("POST").toUpper().toLatin1();
+        scenario.path = obj.value("path").toString();
+        scenario.body = obj.value("body").toString();
+        scenario.weight = obj.value("weight").toInt(1);
+
+        if (scenario.id.isEmpty() || !scenario.path.startsWith('/') || scenario.weight <= 0) {
+            *error = QString("%1:%2: request_id, path and a positive weight are required").arg(fileName).arg(lineNumber);
+            return {};
+        }
+        scenarios.append(scenario);
+    }
+
+    if (scenarios.isEmpty())
+        *error = QString("%1: no scenarios").arg(fileName);
+    return scenarios;
+}
+
+LoadGenerator::LoadGenerator(const Options &options, const QList<Scenario> &scenarios, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_scenarios(scenarios)
+    , m_results(scenarios.size())
+    , m_random(options.seed)
+{
+    int total = 0;
+    for (const Scenario &scenario : m_scenarios) {
+        total += scenario.weight;
+        m_cumulativeWeights.push_back(total);
+    }
+
+    // QNetworkAccessManager держит не больше 6 соединений на хост,
+    // поэтому для большей конкурентности нужны несколько менеджеров.
+    const int managers = (m_options.concurrency + 5) / 6;
+    for (int i = 0; i < managers; ++i)
+        m_managers.push_back(new QNetworkAccessManager(this));
+
+    m_ticker.setTimerType(Qt::PreciseTimer);
+    m_ticker.setInterval(1);
+    connect(&m_ticker, &QTimer::timeout, this, &LoadGenerator::onTick);
+
+    m_progress.setInterval(1000);
+    connect(&m_progress, &QTimer::timeout, this, &LoadGenerator::printProgress);
+}
+
+void LoadGenerator::start()
+{
+    m_clock.start();
+    m_progress.start();
+
+    if (m_options.rate > 0) {
+        m_ticker.start();
+    } else {
+        for (int i = 0; i < m_options.concurrency; ++i)
+            dispatch(m_clock.nsecsElapsed());
+    }
+
+    QTimer::singleShot(m_options.durationSec * 1000, this, [this] {
+        m_stopping = true;
+        m_ticker.stop();
+        m_backlog.clear();
+        if (m_inFlight == 0)
+            finish();
+    });
+}
+
+void LoadGenerator::onTick()
+{
+    // Open loop: прибытия идут по расписанию независимо от ответов сервера.
+    // Задержка считается от запланированного момента, поэтому очередь перед
+    // отправкой входит в неё (без coordinated omission).
+    const qint64 nowNs = m_clock.nsecsElapsed();
+    const quint64 due = quint64(double(nowNs) / 1e9 * m_options.rate);
+    while (m_arrivals < due) {
+        m_backlog.push_back(qint64(double(m_arrivals) * 1e9 / m_options.rate));
+        ++m_arrivals;
+    }
+
+    while (!m_backlog.empty() && m_inFlight < m_options.concurrency) {
+        const qint64 intendedNs = m_backlog.front();
+        m_backlog.pop_front();
+        dispatch(intendedNs);
+    }
+}
+
+void LoadGenerator::dispatch(qint64 intendedNs)
+{
+    const int index = pickScenario();
+    const Scenario &scenario = m_scenarios[index];
+
+    // path и body заполняются одним набором значений: один пользователь, одна дата
+    const Parameters parameters = drawParameters();
+
+    QUrl url = m_options.baseUrl;
+    const QString pathAndQuery = expand(scenario.path, parameters);
+    const qsizetype queryStart = pathAndQuery.indexOf('?');
+    url.setPath(pathAndQuery.left(queryStart));
+    url.setQuery(queryStart >= 0 ? pathAndQuery.mid(queryStart + 1) : QString());
+
+    QNetworkRequest request(url);
+    request.setTransferTimeout(m_options.timeoutMs);
+    if (!m_options.keepAlive)
+        request.setRawHeader("Connection", "close");
+
+    QByteArray body;
+    if (!scenario.body.isEmpty()) {
+        body = expand(scenario.body, parameters).toUtf8();
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    }
+
+    QNetworkAccessManager *manager = m_managers[m_nextManager++ % m_managers.size()];
+    QNetworkReply *reply = manager->sendCustomRequest(request, scenario.method, body);
+    ++m_inFlight;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, index, intendedNs] {
+        onReplyFinished(reply, index, intendedNs);
+    });
+}
+
+void LoadGenerator::onReplyFinished(QNetworkReply *reply, int scenarioIndex, qint64 intendedNs)
+{
+    const qint64 latencyUs = (m_clock.nsecsElapsed() - intendedNs) / 1000;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray payload = reply->readAll();
+
+    Result &result = m_results[scenarioIndex];
+    result.latenciesUs.push_back(latencyUs);
+    result.bytes += quint64(payload.size());
+    if (reply->error() != QNetworkReply::NoError && status == 0)
+        ++result.errors;
+    else if (status >= 500)
+        ++result.errors;
+    else if (status >= 400)
+        ++result.clientErrors;
+
+    reply->deleteLater();
+    --m_inFlight;
+    ++m_completed;
+
+    if (m_stopping) {
+        if (m_inFlight == 0)
+            finish();
+        return;
+    }
+
+    if (m_options.rate > 0)
+        onTick();
+    else
+        dispatch(m_clock.nsecsElapsed());
+}
+
+void LoadGenerator::printProgress()
+{
+    quint64 errors = 0;
+    for (const Result &result : m_results)
+        errors += result.errors;
+
+    std::fprintf(stderr, "[%5.1fs] completed %llu, in flight %d, backlog %zu, errors %llu\n",
+                 double(m_clock.elapsed()) / 1000.0,
+                 static_cast<unsigned long long>(m_completed), m_inFlight, m_backlog.size(),
+                 static_cast<unsigned long long>(errors));
+}
+
+void LoadGenerator::finish()
+{
+    m_progress.stop();
+    report();
+    emit finished();
+}
+
+void LoadGenerator::report() const
+{
+    const double elapsedSec = double(m_clock.elapsed()) / 1000.0;
+
+    auto percentile = [](const std::vector<qint64> &sorted, double p) -> double {
+        if (sorted.empty())
+            return 0;
+        const std::size_t rank = std::size_t(std::ceil(p * double(sorted.size())));
+        return double(sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)]) / 1000.0;
+    };
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+               .arg(QStringLiteral("scenario"), -28).arg(QStringLiteral("count"), 8).arg(QStringLiteral("rps"), 9)
+               .arg(QStringLiteral("p50 ms"), 9).arg(QStringLiteral("p99 ms"), 9).arg(QStringLiteral("p999 ms"), 9)
+               .arg(QStringLiteral("max ms"), 9).arg(QStringLiteral("4xx"), 7).arg(QStringLiteral("errors"), 7);
+
+    std::vector<qint64> all;
+    quint64 totalErrors = 0;
+    quint64 totalClientErrors = 0;
+
+    auto printRow = [&](const QString &name, std::vector<qint64> sorted, quint64 clientErrors, quint64 errors) {
+        std::sort(sorted.begin(), sorted.end());
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+                   .arg(name.left(28), -28)
+                   .arg(qulonglong(sorted.size()), 8)
+                   .arg(double(sorted.size()) / elapsedSec, 9, 'f', 1)
+                   .arg(percentile(sorted, 0.50), 9, 'f', 2)
+                   .arg(percentile(sorted, 0.99), 9, 'f', 2)
+                   .arg(percentile(sorted, 0.999), 9, 'f', 2)
+                   .arg(sorted.empty() ? 0.0 : double(sorted.back()) / 1000.0, 9, 'f', 2)
+                   .arg(qulonglong(clientErrors), 7)
+                   .arg(qulonglong(errors), 7);
+    };
+
+    for (std::size_t i = 0; i < m_results.size(); ++i) {
+        const Result &result = m_results[i];
+        printRow(m_scenarios[int(i)].id, result.latenciesUs, result.clientErrors, result.errors);
+        all.insert(all.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+        totalErrors += result.errors;
+        totalClientErrors += result.clientErrors;
+    }
+    printRow(QStringLiteral("TOTAL"), all, totalClientErrors, totalErrors);
+
+    out << QString("duration %1 s, mode %2, concurrency %3, keep-alive %4\n")
+               .arg(elapsedSec, 0, 'f', 1)
+               .arg(m_options.rate > 0 ? QString("open loop @ %1 rps").arg(m_options.rate) : QString("closed loop"))
+               .arg(m_options.concurrency)
+               .arg(m_options.keepAlive ? QStringLiteral("on") : QStringLiteral("off"));
+}
+
+int LoadGenerator::pickScenario()
+{
+    std::uniform_int_distribution<int> distribution(1, m_cumulativeWeights.back());
+    const int value = distribution(m_random);
+    return int(std::lower_bound(m_cumulativeWeights.begin(), m_cumulativeWeights.end(), value)
+               - m_cumulativeWeights.begin());
+}
+
+LoadGenerator::Parameters LoadGenerator::drawParameters()
+{
+    const QDate today = QDate::currentDate();
+    std::uniform_int_distribution<int> userDistribution(0, qMax(0, m_options.users - 1));
+    std::uniform_int_distribution<int> dayDistribution(0, 364);
+    std::uniform_int_distribution<int> minuteDistribution(0, 24 * 60 - 1);
+    std::uniform_int_distribution<int> randomDistribution(0, 999999);
+
+    const int user = userDistribution(m_random);
+    const QDate date = today.addDays(-dayDistribution(m_random));
+    const QTime time = QTime(0, 0).addSecs(minuteDistribution(m_random) * 60);
+
+    auto ownedId = [this, user](int perUser) {
+        std::uniform_int_distribution<int> distribution(1, qMax(1, perUser));
+        return QString::number(user * perUser + distribution(m_random));
+    };
+
+    return {
+        { "${login}", m_options.userPrefix + QString::number(user) },
+        { "${password}", m_options.password },
+        { "${date}", date.toString(Qt::ISODate) },
+        { "${time}", time.toString("HH:mm") },
+        { "${year}", QString::number(date.year()) },
+        { "${month}", QString::number(date.month()) },
+        { "${yearMonth}", date.toString("yyyy-MM") },
+        { "${prevYearMonth}", date.addMonths(-1).toString("yyyy-MM") },
+        { "${folderId}", ownedId(m_options.foldersPerUser) },
+        { "${tagId}", ownedId(m_options.tagsPerUser) },
+        { "${activityId}", ownedId(m_options.activitiesPerUser) },
+        { "${emotionId}", ownedId(m_options.emotionsPerUser) },
+        { "${random}", QString::number(randomDistribution(m_random)) },
+    };
+}
+
+QString LoadGenerator::expand(const QString &text, const Parameters &parameters)
+{
+    if (!text.contains("${"))
+        return text;
+
+    QString result = text;
+    for (const auto &parameter : parameters)
+        result.replace(parameter.first, parameter.second);
+    return result;
+}
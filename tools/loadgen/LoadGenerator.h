@@ -0,0 +1,105 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QUrl>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <deque>
+#include <random>
+#include <vector>
+
+// Сценарий нагрузки — строка в формате requests.jsonl:
+// {"request_id":..,"title":..,"body":"<тело запроса>","weight":..,"method":"GET|POST","path":".."}
+// В path и body подставляются ${login}, ${password}, ${date}, ${time},
+// ${year}, ${month}, ${yearMonth}, ${prevYearMonth}, ${random}, а также
+// ${folderId}, ${tagId}, ${activityId}, ${emotionId} — id, принадлежащие
+// выбранному пользователю, если база заполнена tools/datagen: у пользователя
+// с номером u папки имеют id u*folders+1 .. (u+1)*folders, и так же остальные.
+struct Scenario {
+    QString id;
+    QString title;
+    QByteArray method = "POST";
+    QString path;
+    QString body;
+    int weight = 1;
+
+    static QList<Scenario> loadJsonLines(const QString &fileName, QString *error);
+};
+
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QUrl baseUrl = QUrl("http://127.0.0.1:8080");
+        int concurrency = 8;          // одновременных запросов (в open-loop — верхняя граница)
+        double rate = 0;              // запросов в секунду; 0 — closed loop
+        int durationSec = 30;
+        int timeoutMs = 10000;
+        bool keepAlive = true;
+        int users = 100;              // логины ${login}: <userPrefix><0..users-1>
+        QString userPrefix = "loaduser";
+        QString password = "password";
+        int foldersPerUser = 3;
+        int tagsPerUser = 10;
+        int activitiesPerUser = 8;
+        int emotionsPerUser = 8;
+        quint32 seed = 1;
+    };
+
+    LoadGenerator(const Options &options, const QList<Scenario> &scenarios, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished();
+
+private:
+    struct Result {
+        std::vector<qint64> latenciesUs;
+        quint64 errors = 0;           // сеть, таймаут, 5xx
+        quint64 clientErrors = 0;     // 4xx
+        quint64 bytes = 0;
+    };
+
+    void dispatch(qint64 intendedNs);
+    void onReplyFinished(QNetworkReply *reply, int scenarioIndex, qint64 intendedNs);
+    void onTick();
+    void printProgress();
+    void finish();
+    void report() const;
+
+    using Parameters = QList<QPair<QString, QString>>;
+
+    int pickScenario();
+    Parameters drawParameters();
+    static QString expand(const QString &text, const Parameters &parameters);
+
+    Options m_options;
+    QList<Scenario> m_scenarios;
+    std::vector<int> m_cumulativeWeights;
+    std::vector<Result> m_results;
+    std::vector<QNetworkAccessManager *> m_managers;
+    std::size_t m_nextManager = 0;
+    std::mt19937 m_random;
+
+    QElapsedTimer m_clock;
+    QTimer m_ticker;
+    QTimer m_progress;
+    std::deque<qint64> m_backlog;     // open loop: прибытия, ждущие свободного слота
+    quint64 m_arrivals = 0;
+    quint64 m_completed = 0;
+    int m_inFlight = 0;
+    bool m_stopping = false;
+};
+
+#endif // LOADGENERATOR_H
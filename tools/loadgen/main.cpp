@@ -0,0 +1,66 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include "LoadGenerator.h"
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("psqlserver-loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays weighted JSON-lines scenarios against PSQLSERVER.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scenarios", "Scenario file in requests.jsonl format.");
+
+    const QCommandLineOption urlOption("url", "Server base URL.", "url", "http://127.0.0.1:8080");
+    const QCommandLineOption concurrencyOption({"c", "concurrency"}, "Concurrent requests.", "n", "8");
+    const QCommandLineOption rateOption({"r", "rate"}, "Open-loop arrival rate, requests/s (0 = closed loop).", "rps", "0");
+    const QCommandLineOption durationOption({"d", "duration"}, "Test duration in seconds.", "sec", "30");
+    const QCommandLineOption timeoutOption("timeout", "Per-request timeout in milliseconds.", "ms", "10000");
+    const QCommandLineOption noKeepAliveOption("no-keepalive", "Send Connection: close with every request.");
+    const QCommandLineOption usersOption("users", "Number of distinct ${login} values.", "n", "100");
+    const QCommandLineOption userPrefixOption("user-prefix", "Login prefix for ${login}.", "prefix", "loaduser");
+    const QCommandLineOption passwordOption("password", "Value of ${password}.", "password", "password");
+    const QCommandLineOption foldersOption("folders", "Folders per user in the datagen id layout.", "n", "3");
+    const QCommandLineOption tagsOption("tags", "Tags per user in the datagen id layout.", "n", "10");
+    const QCommandLineOption activitiesOption("activities", "Activities per user in the datagen id layout.", "n", "8");
+    const QCommandLineOption emotionsOption("emotions", "Emotions per user in the datagen id layout.", "n", "8");
+    const QCommandLineOption seedOption("seed", "Random seed for scenario and parameter choice.", "seed", "1");
+    parser.addOptions({ urlOption, concurrencyOption, rateOption, durationOption, timeoutOption, noKeepAliveOption,
+                        usersOption, userPrefixOption, passwordOption, foldersOption, tagsOption, activitiesOption,
+                        emotionsOption, seedOption });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    QString error;
+    const QList<Scenario> scenarios = Scenario::loadJsonLines(parser.positionalArguments().first(), &error);
+    if (scenarios.isEmpty()) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    LoadGenerator::Options options;
+    options.baseUrl = QUrl(parser.value(urlOption));
+    options.concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+    options.rate = qMax(0.0, parser.value(rateOption).toDouble());
+    options.durationSec = qMax(1, parser.value(durationOption).toInt());
+    options.timeoutMs = qMax(1, parser.value(timeoutOption).toInt());
+    options.keepAlive = !parser.isSet(noKeepAliveOption);
+    options.users = qMax(1, parser.value(usersOption).toInt());
+    options.userPrefix = parser.value(userPrefixOption);
+    options.password = parser.value(passwordOption);
+    options.foldersPerUser = qMax(1, parser.value(foldersOption).toInt());
+    options.tagsPerUser = qMax(1, parser.value(tagsOption).toInt());
+    options.activitiesPerUser = qMax(1, parser.value(activitiesOption).toInt());
+    options.emotionsPerUser = qMax(1, parser.value(emotionsOption).toInt());
+    options.seed = parser.value(seedOption).toUInt();
+
+    LoadGenerator generator(options, scenarios);
+    QObject::connect(&generator, &LoadGenerator::finished, &app, &QCoreApplication::quit);
+    generator.start();
+
+    return app.exec();
+}